@@ -0,0 +1,105 @@
+/**
+ * Measures the throughput of `sharded_chaining_map` and `striped_chaining_map` with 1 up to 64 threads.
+ * Each thread inserts its share of random keys, then all threads look up random keys.
+ * A single `separate_chaining_map` guarded by one mutex serves as a baseline.
+ *
+ * usage: bench_concurrent [number of elements] [maximum number of threads]
+ */
+#include <separate/separate_chaining_table.hpp>
+#include <separate/sharded_chaining_map.hpp>
+#include <separate/striped_chaining_map.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+using value_type = uint64_t;
+using map_type = separate_chaining_map<varwidth_bucket<>, plain_bucket<value_type>, xorshift_hash<key_type>>;
+using sharded_type = sharded_chaining_map<map_type, 64>;
+using striped_type = striped_chaining_map<map_type>;
+
+//! single hash table guarded by a global lock, offering the interface of `sharded_chaining_map` used here
+class locked_map {
+   mutable std::mutex m_mutex;
+   map_type m_map;
+
+   public:
+   locked_map(uint_fast8_t key_width) : m_map(key_width) {}
+
+   value_type find_or_insert(const key_type& key, value_type&& value) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_map.find_or_insert(key, std::move(value)).value();
+   }
+   bool find(const key_type& key, value_type& value) const {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const auto it = m_map.find(key);
+      if(it == m_map.cend()) { return false; }
+      value = it->second;
+      return true;
+   }
+   size_t size_in_bytes() const { return m_map.size_in_bytes(); }
+};
+
+template<class function_type>
+double measure(const size_t threads, function_type&& function) {
+   std::vector<std::thread> workers;
+   const auto start = std::chrono::steady_clock::now();
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back(function, t);
+   }
+   for(auto& worker : workers) { worker.join(); }
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class T>
+void run(const std::string& name, const std::vector<key_type>& keys, const size_t threads) {
+   T map(64);
+   const size_t elements = keys.size();
+   const double insert_time = measure(threads, [&] (const size_t t) {
+      for(size_t i = t; i < elements; i += threads) {
+         map.find_or_insert(keys[i], value_type(i));
+      }
+   });
+   const double find_time = measure(threads, [&] (const size_t t) {
+      std::mt19937_64 generator(t);
+      size_t found = 0;
+      for(size_t i = 0; i < elements / threads; ++i) {
+         value_type value;
+         found += map.find(keys[generator() % elements], value);
+      }
+      if(found != elements / threads) { std::cerr << "missing keys!" << std::endl; }
+   });
+   std::cout << "RESULT"
+      << " type=" << name
+      << " threads=" << threads
+      << " elements=" << elements
+      << " insert_time=" << insert_time
+      << " find_time=" << find_time
+      << " insert_mops=" << (elements / insert_time / 1e6)
+      << " find_mops=" << (elements / find_time / 1e6)
+      << " bytes=" << map.size_in_bytes()
+      << std::endl;
+}
+
+int main(int argc, char** argv) {
+   const size_t elements = argc > 1 ? std::stoull(argv[1]) : 1ULL<<22;
+   const size_t max_threads = argc > 2 ? std::stoull(argv[2]) : 64;
+
+   std::vector<key_type> keys(elements);
+   std::mt19937_64 generator(1);
+   for(auto& key : keys) { key = generator(); }
+
+   for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+      run<locked_map>("locked", keys, threads);
+      run<sharded_type>("sharded", keys, threads);
+      run<striped_type>("striped", keys, threads);
+   }
+   return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * Compares `ordered_erase` with `unordered_erase` on a sliding window:
+ * every step inserts a new key and erases the key inserted `window` steps before.
+ *
+ * usage: bench_erase [window size] [number of steps]
+ */
+#include <separate/separate_chaining_table.hpp>
+#include <separate/compact_chaining_map.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+
+template<class T>
+void run(const std::string& name, T& map, const std::vector<key_type>& keys, const size_t window) {
+   for(size_t i = 0; i < window; ++i) { map[keys[i]] = i; }
+   const auto start = std::chrono::steady_clock::now();
+   size_t erased = 0;
+   for(size_t i = window; i < keys.size(); ++i) {
+      map[keys[i]] = i;
+      erased += map.erase(keys[i-window]);
+   }
+   const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   if(erased != keys.size()-window) { std::cerr << "missing keys!" << std::endl; }
+   std::cout << "RESULT"
+      << " type=" << name
+      << " window=" << window
+      << " steps=" << (keys.size()-window)
+      << " time=" << time
+      << " mops=" << ((keys.size()-window) / time / 1e6)
+      << std::endl;
+}
+
+int main(int argc, char** argv) {
+   const size_t window = argc > 1 ? std::stoull(argv[1]) : 1ULL<<20;
+   const size_t steps = argc > 2 ? std::stoull(argv[2]) : 1ULL<<23;
+
+   // distinct keys, such that each erasure removes exactly the key inserted `window` steps before
+   std::vector<key_type> keys(window+steps);
+   std::mt19937_64 generator(1);
+   for(size_t i = 0; i < keys.size(); ++i) { keys[i] = ((generator() & ((1ULL<<20)-1)) << 28) | i; }
+
+   {
+      separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<key_type>, incremental_resize, dummy_overflow, malloc_allocator, ordered_erase> map(48);
+      run("varwidth_ordered", map, keys, window);
+   }
+   {
+      separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<key_type>, incremental_resize, dummy_overflow, malloc_allocator, unordered_erase> map(48);
+      run("varwidth_unordered", map, keys, window);
+   }
+   {
+      separate_chaining_map<plain_bucket<key_type>, plain_bucket<uint32_t>, hash_mapping_adapter<key_type, SplitMix>, incremental_resize, dummy_overflow, malloc_allocator, ordered_erase> map;
+      run("plain_ordered", map, keys, window);
+   }
+   {
+      separate_chaining_map<plain_bucket<key_type>, plain_bucket<uint32_t>, hash_mapping_adapter<key_type, SplitMix>, incremental_resize, dummy_overflow, malloc_allocator, unordered_erase> map;
+      run("plain_unordered", map, keys, window);
+   }
+   {
+      compact_chaining_map<xorshift_hash<key_type>, uint8_t, ordered_erase> map(48, 32);
+      run("compact_ordered", map, keys, window);
+   }
+   {
+      compact_chaining_map<xorshift_hash<key_type>, uint8_t, unordered_erase> map(48, 32);
+      run("compact_unordered", map, keys, window);
+   }
+   return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * Compares a `separate_chaining_map` with its `frozen_chaining_table` in space and lookup time.
+ *
+ * usage: bench_frozen [number of elements]
+ */
+#include <separate/separate_chaining_table.hpp>
+#include <separate/frozen_chaining_table.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+using value_type = uint32_t;
+
+template<class T>
+void run(const std::string& name, const T& map, const std::vector<key_type>& keys) {
+   std::mt19937_64 generator(2);
+   size_t found = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for(size_t i = 0; i < keys.size(); ++i) {
+      found += map.find(keys[generator() % keys.size()]) != map.cend();
+   }
+   const double find_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   if(found != keys.size()) { std::cerr << "missing keys!" << std::endl; }
+   std::cout << "RESULT"
+      << " type=" << name
+      << " elements=" << map.size()
+      << " find_time=" << find_time
+      << " find_mops=" << (keys.size() / find_time / 1e6)
+      << " bytes=" << map.size_in_bytes()
+      << " bytes_per_element=" << (static_cast<double>(map.size_in_bytes()) / map.size())
+      << std::endl;
+}
+
+template<class T>
+void run_all(const std::string& name, T& map, const std::vector<key_type>& keys) {
+   for(size_t i = 0; i < keys.size(); ++i) { map[keys[i]] = i; }
+   run(name, map, keys);
+   const auto frozen = freeze(map);
+   run(name + "_frozen", frozen, keys);
+}
+
+int main(int argc, char** argv) {
+   const size_t elements = argc > 1 ? std::stoull(argv[1]) : 1ULL<<22;
+
+   std::vector<key_type> keys(elements);
+   std::mt19937_64 generator(1);
+   for(auto& key : keys) { key = generator() & ((1ULL<<40)-1); }
+
+   {
+      separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>> map;
+      run_all("plain", map, keys);
+   }
+   {
+      separate_chaining_map<varwidth_bucket<>, plain_bucket<value_type>, xorshift_hash<key_type>> map(40);
+      run_all("varwidth", map, keys);
+   }
+   return 0;
+}
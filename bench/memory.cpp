@@ -0,0 +1,197 @@
+/**
+ * Measures the real memory footprint of the tables while filling them, and compares it with the byte count they report.
+ * At each of `steps` load levels, it writes
+ * - `heap`: the bytes the table holds on the heap, measured by `mallinfo2` (including malloc headers and rounding),
+ * - `rss`: the growth of the resident set size since the table was created,
+ * - `reported`: the bytes reported by `size_in_bytes()`, or by `stats().bytes()` for tables without `size_in_bytes()`,
+ * - `lower_bound`: the information-theoretic lower bound, i.e., log2 of (2^key_width choose elements) bits plus the bits of the values.
+ * For comparison, `open_addressing_map` is a linear probing table storing keys and values in two plain arrays, for different maximum load factors.
+ * The heap measurement relies on glibc; the RSS grows monotonically as freed pages are usually not returned to the system.
+ *
+ * usage: bench_memory [number of elements] [key width] [steps]
+ */
+#include <separate/separate_chaining_table.hpp>
+#include <separate/compact_chaining_map.hpp>
+#include <separate/group_chaining.hpp>
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+using value_type = uint32_t;
+
+//! bytes handed out by malloc, including its per-allocation headers
+size_t heap_bytes() {
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+   const struct mallinfo2 info = mallinfo2();
+   return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+   const struct mallinfo info = mallinfo();
+   return static_cast<size_t>(static_cast<unsigned>(info.uordblks)) + static_cast<size_t>(static_cast<unsigned>(info.hblkhd));
+#else
+   return 0;
+#endif
+}
+
+//! resident set size in bytes, read from `/proc/self/statm`
+size_t rss_bytes() {
+   std::ifstream statm("/proc/self/statm");
+   size_t pages = 0;
+   size_t resident = 0;
+   if(!(statm >> pages >> resident)) { return 0; }
+   return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Hash table with open addressing and linear probing, storing keys and values in separate arrays.
+ * It doubles its capacity once the number of elements would exceed `max_load_factor` times its capacity.
+ * It only supports insertions, and serves as the baseline for the memory overhead of the bucket pointers and bucket sizes of separate chaining.
+ */
+class open_addressing_map {
+   static constexpr key_type EMPTY = -1ULL; //! marks an unused slot; this key cannot be stored
+
+   std::vector<key_type> m_keys;
+   std::vector<value_type> m_values;
+   size_t m_elements = 0;
+   const double m_max_load_factor;
+
+   size_t slot(const key_type& key) const {
+      size_t i = SplitMix()(key) & (m_keys.size()-1);
+      while(m_keys[i] != EMPTY && m_keys[i] != key) { i = (i+1) & (m_keys.size()-1); }
+      return i;
+   }
+
+   void grow() {
+      std::vector<key_type> keys(std::max<size_t>(16, m_keys.size()*2), EMPTY);
+      std::vector<value_type> values(keys.size());
+      keys.swap(m_keys);
+      values.swap(m_values);
+      for(size_t i = 0; i < keys.size(); ++i) {
+         if(keys[i] == EMPTY) { continue; }
+         const size_t j = slot(keys[i]);
+         m_keys[j] = keys[i];
+         m_values[j] = values[i];
+      }
+   }
+
+   public:
+   open_addressing_map(const double max_load_factor) : m_max_load_factor(max_load_factor) {}
+
+   value_type& operator[](const key_type& key) {
+      DDCHECK_NE(key, EMPTY);
+      if(m_elements+1 > m_max_load_factor * m_keys.size()) { grow(); }
+      const size_t i = slot(key);
+      if(m_keys[i] == EMPTY) {
+         m_keys[i] = key;
+         m_values[i] = 0;
+         ++m_elements;
+      }
+      return m_values[i];
+   }
+
+   size_t size() const { return m_elements; }
+   size_t size_in_bytes() const { return sizeof(*this) + m_keys.capacity()*sizeof(key_type) + m_values.capacity()*sizeof(value_type); }
+};
+
+//! whether `map_type` has the member function `size_in_bytes`
+template<class map_type, class = void>
+struct has_size_in_bytes : std::false_type {};
+template<class map_type>
+struct has_size_in_bytes<map_type, std::void_t<decltype(std::declval<const map_type&>().size_in_bytes())>> : std::true_type {};
+
+template<class map_type>
+size_t reported_bytes(const map_type& map) {
+   if constexpr(has_size_in_bytes<map_type>::value) { return map.size_in_bytes(); }
+   else { return map.stats().bytes(); }
+}
+
+/**
+ * Inserts `keys` into a table created by `make`, and reports the memory at `steps` equally spaced load levels.
+ * `lower_bounds[i]` is the lower bound in bits for storing the first `i` keys.
+ */
+template<class make_type>
+void run(const std::string& name, make_type&& make, const std::vector<key_type>& keys, const std::vector<double>& lower_bounds, const size_t steps) {
+   const size_t heap_before = heap_bytes();
+   const size_t rss_before = rss_bytes();
+   {
+      auto map = make();
+      size_t inserted = 0;
+      for(size_t step = 1; step <= steps; ++step) {
+         const size_t target = keys.size() * step / steps;
+         for(; inserted < target; ++inserted) { (*map)[keys[inserted]] = inserted; }
+
+         const size_t heap = heap_bytes() - heap_before;
+         const size_t reported = reported_bytes(*map);
+         const double lower_bound = lower_bounds[inserted] / 8;
+         std::cout << "RESULT"
+            << " type=" << name
+            << " elements=" << map->size()
+            << " heap=" << heap
+            << " rss=" << (rss_bytes() - rss_before)
+            << " reported=" << reported
+            << " lower_bound=" << static_cast<size_t>(lower_bound)
+            << " heap_per_element=" << (static_cast<double>(heap) / map->size())
+            << " reported_per_element=" << (static_cast<double>(reported) / map->size())
+            << " heap_over_reported=" << (static_cast<double>(heap) / reported)
+            << " heap_over_lower_bound=" << (heap / lower_bound)
+            << std::endl;
+      }
+   }
+   malloc_trim(0);
+}
+
+int main(int argc, char** argv) {
+   const size_t elements = argc > 1 ? std::stoull(argv[1]) : 1ULL<<22;
+   const unsigned key_width = argc > 2 ? std::stoul(argv[2]) : 40;
+   const size_t steps = argc > 3 ? std::stoull(argv[3]) : 8;
+   if(key_width < 2 || key_width > 63 || elements >= (1ULL<<(key_width-1)) || steps == 0) {
+      std::cerr << "the key width has to be in [2,63], and there have to be fewer than 2^(key width-1) elements" << std::endl;
+      return 1;
+   }
+
+   //! distinct keys, since a bijective hash function maps distinct integers to distinct keys
+   std::vector<key_type> keys(elements);
+   {
+      const uint64_t mask = (1ULL<<key_width)-1;
+      std::mt19937_64 generator(1);
+      const uint64_t offset = generator();
+      for(size_t i = 0; i < elements; ++i) { keys[i] = bijective_hash::Xorshift(key_width)(static_cast<uint64_t>(i + offset) & mask); }
+   }
+
+   //! log2 of (2^key_width choose i) computed incrementally by (U choose i+1) = (U choose i) * (U-i)/(i+1), plus the value bits
+   std::vector<double> lower_bounds(elements+1, 0);
+   {
+      const long double universe = std::ldexp(1.0L, key_width);
+      long double bits = 0;
+      for(size_t i = 0; i < elements; ++i) {
+         bits += std::log2((universe - i) / (i+1));
+         lower_bounds[i+1] = static_cast<double>(bits) + (i+1) * sizeof(value_type) * 8.0;
+      }
+   }
+
+   run("plain_SplitMix_incremental", [] { return std::make_unique<separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>, incremental_resize>>(); }, keys, lower_bounds, steps);
+   run("plain_SplitMix_arbitrary", [] { return std::make_unique<separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>, arbitrary_resize>>(); }, keys, lower_bounds, steps);
+   run("plain_Xor_slab", [key_width] { return std::make_unique<separate_chaining_map<plain_bucket<key_type, slab_allocator>, plain_bucket<value_type, slab_allocator>, xorshift_hash<key_type>, incremental_resize, dummy_overflow, slab_allocator>>(key_width); }, keys, lower_bounds, steps);
+#ifdef __AVX2__
+   run("avx2_SplitMix", [] { return std::make_unique<separate_chaining_map<avx2_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>>>(); }, keys, lower_bounds, steps);
+#endif
+   run("varwidth_Xor_incremental", [key_width] { return std::make_unique<separate_chaining_map<varwidth_bucket<>, plain_bucket<value_type>, xorshift_hash<key_type>, incremental_resize>>(key_width); }, keys, lower_bounds, steps);
+   run("varwidth_Xor_arbitrary", [key_width] { return std::make_unique<separate_chaining_map<varwidth_bucket<>, plain_bucket<value_type>, xorshift_hash<key_type>, arbitrary_resize>>(key_width); }, keys, lower_bounds, steps);
+   run("varwidth_Xor_slab", [key_width] { return std::make_unique<separate_chaining_map<varwidth_bucket<uint8_t, slab_allocator>, plain_bucket<value_type, slab_allocator>, xorshift_hash<key_type>, incremental_resize, dummy_overflow, slab_allocator>>(key_width); }, keys, lower_bounds, steps);
+   run("compact_Xor", [key_width] { return std::make_unique<compact_chaining_map<xorshift_hash<>>>(key_width, sizeof(value_type)*8); }, keys, lower_bounds, steps);
+   run("group_Xor", [key_width] { return std::make_unique<group::group_chaining_table<>>(key_width, sizeof(value_type)*8); }, keys, lower_bounds, steps);
+   for(const double max_load_factor : { 0.5, 0.75, 0.9 }) {
+      run("open_addressing_" + std::to_string(max_load_factor).substr(0, 4), [max_load_factor] { return std::make_unique<open_addressing_map>(max_load_factor); }, keys, lower_bounds, steps);
+   }
+   return 0;
+}
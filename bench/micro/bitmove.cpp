@@ -0,0 +1,69 @@
+/**
+ * Microbenchmarks of `move_bits` against moving the bits in 64-bit chunks with `tdc::tdc_sdsl::bits_impl`,
+ * as done by `varwidth_bucket::erase` and `core_group::erase` before they used `move_bits`.
+ * Each benchmark moves the bits of `elements` fields of `width` bits by one field, to the front like an erase (`front`) or to the back like an insert (`back`).
+ * The benchmarks are named `bitmove/<variant>/<direction>/<width>/<elements>`.
+ */
+#include "micro.hpp"
+
+#include <separate/bitmove.hpp>
+
+using namespace separate_chaining;
+
+static const std::vector<unsigned> widths = { 8, 9, 17, 30, 64 };
+static const std::vector<size_t> element_counts = { 16, 255, 4096, 65536 };
+
+//! moves `bits` bits from bit `from` to bit `to < from` in 64-bit chunks
+void sdsl_move_front(uint64_t* data, const uint64_t to, const uint64_t from, const uint64_t bits) {
+   const uint64_t* read_it = data + from/64;
+   uint8_t read_offset = from % 64;
+   uint64_t* write_it = data + to/64;
+   uint8_t write_offset = to % 64;
+   for(size_t i = 0; i < bits/64; ++i) {
+      const uint64_t chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, 64);
+      tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, chunk, write_offset, 64);
+   }
+   if(bits % 64 > 0) {
+      const uint64_t chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, bits % 64);
+      tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, chunk, write_offset, bits % 64);
+   }
+}
+
+//! moves `bits` bits from bit `from` to bit `to > from` in 64-bit chunks, starting with the last chunk
+void sdsl_move_back(uint64_t* data, const uint64_t to, const uint64_t from, uint64_t bits) {
+   for(; bits >= 64; bits -= 64) {
+      const uint64_t chunk = tdc::tdc_sdsl::bits_impl<>::read_int(data + (from+bits-64)/64, (from+bits-64) % 64, 64);
+      tdc::tdc_sdsl::bits_impl<>::write_int(data + (to+bits-64)/64, chunk, (to+bits-64) % 64, 64);
+   }
+   if(bits > 0) {
+      const uint64_t chunk = tdc::tdc_sdsl::bits_impl<>::read_int(data + from/64, from % 64, bits);
+      tdc::tdc_sdsl::bits_impl<>::write_int(data + to/64, chunk, to % 64, bits);
+   }
+}
+
+template<class move_type>
+void bm_move(benchmark::State& state, const unsigned width, const size_t elements, const bool front, move_type&& move) {
+   std::vector<uint64_t> data(ceil_div<size_t>((elements+1)*width, 64)+1);
+   for(size_t i = 0; i < data.size(); ++i) { data[i] = micro::scramble(i, 64); }
+   const uint64_t bits = static_cast<uint64_t>(elements)*width;
+   for(auto _ : state) {
+      if(front) { move(data.data(), 0, width, bits); }
+      else { move(data.data(), width, 0, bits); }
+      benchmark::DoNotOptimize(data.data());
+      benchmark::ClobberMemory();
+   }
+   state.SetBytesProcessed(state.iterations() * (bits/8));
+}
+
+static const bool registered = [] {
+   for(const unsigned width : widths) {
+      for(const size_t elements : element_counts) {
+         const std::string suffix = "/" + std::to_string(width) + "/" + std::to_string(elements);
+         benchmark::RegisterBenchmark(("bitmove/sdsl/front" + suffix).c_str(), [=](benchmark::State& state) { bm_move(state, width, elements, true, sdsl_move_front); });
+         benchmark::RegisterBenchmark(("bitmove/move_bits/front" + suffix).c_str(), [=](benchmark::State& state) { bm_move(state, width, elements, true, move_bits<uint64_t>); });
+         benchmark::RegisterBenchmark(("bitmove/sdsl/back" + suffix).c_str(), [=](benchmark::State& state) { bm_move(state, width, elements, false, sdsl_move_back); });
+         benchmark::RegisterBenchmark(("bitmove/move_bits/back" + suffix).c_str(), [=](benchmark::State& state) { bm_move(state, width, elements, false, move_bits<uint64_t>); });
+      }
+   }
+   return true;
+}();
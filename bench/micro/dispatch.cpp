@@ -0,0 +1,88 @@
+/**
+ * Microbenchmarks of the runtime-dispatched search of `dispatch_bucket`.
+ * `bucket_find` searches a single bucket with each search kernel called directly, with `dispatch_bucket::find`, with `plain_bucket::find`
+ * (the SWAR kernel for 8- and 16-bit elements, a scalar loop otherwise), and, in builds with AVX2 enabled at compile time, with `avx2_bucket::find`, such that the cost of the dispatch is the difference
+ * between `dispatch_bucket` and the kernel of `simd::best_isa()` or `avx2_bucket`.
+ * The benchmarks are named `bucket_find/<variant>/<bits>/<bucket length>`.
+ * Additionally, `separate_chaining_map` is benchmarked with `dispatch_bucket` keys as in `micro_separate_avx2`.
+ */
+#include "micro.hpp"
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+//! bucket lengths of `bucket_find`, up to the largest bucket size a 8-bit quotient can fill with distinct elements
+static const std::vector<size_t> bucket_lengths = { 4, 16, 64, 255 };
+
+//! `length` distinct non-zero elements and 4096 queries, of which about 1/(length+1) miss
+template<class storage_type>
+struct bucket_workload {
+   std::vector<storage_type> elements;
+   std::vector<storage_type> queries;
+
+   bucket_workload(const size_t length) : elements(length), queries(4096) {
+      for(size_t i = 0; i < length; ++i) { elements[i] = static_cast<storage_type>(i+1); }
+      std::mt19937_64 generator(length);
+      std::uniform_int_distribution<size_t> position(0, length);
+      for(storage_type& query : queries) { query = static_cast<storage_type>(position(generator)); } // 0 is not stored
+   }
+};
+
+template<class storage_type, class search_type>
+void run_queries(benchmark::State& state, const bucket_workload<storage_type>& load, search_type&& search) {
+   size_t found = 0;
+   for(auto _ : state) {
+      for(const storage_type query : load.queries) { found += search(query) != -1ULL; }
+      benchmark::DoNotOptimize(found);
+   }
+   state.SetItemsProcessed(state.iterations() * load.queries.size());
+}
+
+template<class storage_type>
+void bm_kernel(benchmark::State& state, const simd::isa level, const size_t length) {
+   const bucket_workload<storage_type> load(length);
+   const simd::find_function<storage_type> kernel = simd::find_kernel<storage_type>(level);
+   const storage_type* data = load.elements.data();
+   run_queries(state, load, [&](const storage_type query) { return kernel(data, length, query); });
+}
+
+template<class bucket_type>
+void bm_bucket(benchmark::State& state, const size_t length) {
+   using storage_type = typename bucket_type::storage_type;
+   const bucket_workload<storage_type> load(length);
+   bucket_type bucket;
+   bucket.initialize(length, sizeof(storage_type)*8);
+   for(size_t i = 0; i < length; ++i) { bucket.write(i, load.elements[i], sizeof(storage_type)*8); }
+   run_queries(state, load, [&](const storage_type query) { return bucket.find(query, length, sizeof(storage_type)*8); });
+   bucket.clear();
+}
+
+template<class storage_type>
+void register_bucket_find() {
+   const std::string bits = std::to_string(sizeof(storage_type)*8);
+   for(const size_t length : bucket_lengths) {
+      const std::string suffix = "/" + bits + "/" + std::to_string(length);
+      for(const simd::isa level : { simd::isa::scalar, simd::isa::swar, simd::isa::avx2, simd::isa::avx512 }) {
+         if(!simd::supported(level)) { continue; }
+         benchmark::RegisterBenchmark(("bucket_find/" + std::string(simd::isa_name(level)) + suffix).c_str(), bm_kernel<storage_type>, level, length);
+      }
+      benchmark::RegisterBenchmark(("bucket_find/plain_bucket" + suffix).c_str(), bm_bucket<plain_bucket<storage_type>>, length);
+      benchmark::RegisterBenchmark(("bucket_find/dispatch_bucket" + suffix).c_str(), bm_bucket<dispatch_bucket<storage_type>>, length);
+#ifdef __AVX2__
+      benchmark::RegisterBenchmark(("bucket_find/avx2_bucket" + suffix).c_str(), bm_bucket<avx2_bucket<storage_type>>, length);
+#endif
+   }
+}
+
+static const bool registered = [] {
+   benchmark::AddCustomContext("dispatched_isa", simd::isa_name(simd::best_isa()));
+   register_bucket_find<uint8_t>();
+   register_bucket_find<uint16_t>();
+   register_bucket_find<uint32_t>();
+   register_bucket_find<uint64_t>();
+   register_separate<dispatch_bucket<uint8_t>>("dispatch_8", {8});
+   register_separate<dispatch_bucket<uint16_t>>("dispatch_16", {16});
+   register_separate<dispatch_bucket<uint32_t>>("dispatch_32", {32});
+   register_separate<dispatch_bucket<uint64_t>>("dispatch_64", {64});
+   return true;
+}();
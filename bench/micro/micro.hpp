@@ -0,0 +1,238 @@
+#pragma once
+
+/**
+ * Shared harness of the Google Benchmark suite in `bench/micro`.
+ * Each executable registers a matrix of tables, key widths, numbers of elements, and operations with `register_map`.
+ * The keys are deterministic, such that two runs measure exactly the same workload.
+ * The largest number of elements is 10^SEPARATE_BENCH_MAX_LOG10, set by the CMake variable of the same name.
+ */
+#include <benchmark/benchmark.h>
+#include <separate/separate_chaining_table.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifndef SEPARATE_BENCH_MAX_LOG10
+#define SEPARATE_BENCH_MAX_LOG10 6
+#endif
+
+namespace separate_chaining {
+namespace micro {
+
+constexpr size_t min_log10 = 3; //! the smallest number of elements is 10^min_log10
+
+//! operations of the matrix, combined as a bit mask
+enum operation : unsigned {
+   op_insert = 1,
+   op_find_positive = 2,
+   op_find_negative = 4,
+   op_erase = 8,
+   op_iterate = 16,
+   op_serialize = 32,
+   op_all = 63,
+};
+
+//! maps `i` bijectively to a `width`-bit integer, such that consecutive values of `i` give distinct and scattered keys
+inline uint64_t scramble(uint64_t i, const unsigned width) {
+   const uint64_t mask = (-1ULL) >> (64-width);
+   const unsigned shift = (width+1)/2;
+   i = (i * 0x9e3779b97f4a7c15ULL) & mask;
+   i ^= i >> shift;
+   i = (i * 0xbf58476d1ce4e5b9ULL) & mask;
+   return i ^ (i >> shift);
+}
+
+//! `n` stored keys, `n` keys that are not stored, and the stored keys in the random order of the lookups
+struct workload {
+   size_t n = 0;
+   unsigned width = 0;
+   std::vector<uint64_t> keys;
+   std::vector<uint64_t> absent;
+   std::vector<uint64_t> queries;
+};
+
+//! generates the workload of `n` keys with `width` bits, and keeps the last one since the benchmarks of one workload are registered consecutively
+inline const workload& get_workload(const size_t n, const unsigned width) {
+   static workload cached;
+   if(cached.n == n && cached.width == width) { return cached; }
+   cached = workload();
+   cached.n = n;
+   cached.width = width;
+   cached.keys.resize(n);
+   cached.absent.resize(n);
+   for(size_t i = 0; i < n; ++i) {
+      cached.keys[i] = scramble(i, width);
+      cached.absent[i] = scramble(n+i, width);
+   }
+   cached.queries = cached.keys;
+   std::shuffle(cached.queries.begin(), cached.queries.end(), std::mt19937_64(width));
+   return cached;
+}
+
+//! whether `map_type` can be iterated by `cbegin()` and `cend()`
+template<class map_type, class = void>
+struct is_iterable : std::false_type {};
+template<class map_type>
+struct is_iterable<map_type, std::void_t<decltype(std::declval<const map_type&>().cbegin())>> : std::true_type {};
+
+//! whether `map_type` has the member functions `serialize` and `deserialize`
+template<class map_type, class = void>
+struct is_serializable : std::false_type {};
+template<class map_type>
+struct is_serializable<map_type, std::void_t<decltype(std::declval<map_type&>().deserialize(std::declval<std::istream&>()))>> : std::true_type {};
+
+template<class map_type>
+using map_factory = std::function<std::unique_ptr<map_type>(unsigned width)>;
+
+template<class map_type>
+void fill(map_type& map, const std::vector<uint64_t>& keys) {
+   for(const uint64_t key : keys) { map[key] = static_cast<uint32_t>(key); }
+}
+
+template<class map_type>
+void bm_insert(benchmark::State& state, const map_factory<map_type>& make, const unsigned width, const size_t n) {
+   const workload& load = get_workload(n, width);
+   for(auto _ : state) {
+      std::unique_ptr<map_type> map = make(width);
+      fill(*map, load.keys);
+      benchmark::DoNotOptimize(map->size());
+      state.PauseTiming();
+      map.reset();
+      state.ResumeTiming();
+   }
+   state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class map_type>
+void bm_find(benchmark::State& state, const map_factory<map_type>& make, const unsigned width, const size_t n, const bool positive) {
+   const workload& load = get_workload(n, width);
+   std::unique_ptr<map_type> map = make(width);
+   fill(*map, load.keys);
+   const std::vector<uint64_t>& queries = positive ? load.queries : load.absent;
+   size_t found = 0;
+   for(auto _ : state) {
+      for(const uint64_t key : queries) { found += map->count(key); }
+      benchmark::DoNotOptimize(found);
+   }
+   if(found != (positive ? state.iterations() * n : 0)) { state.SkipWithError("wrong number of found keys"); }
+   state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class map_type>
+void bm_erase(benchmark::State& state, const map_factory<map_type>& make, const unsigned width, const size_t n) {
+   const workload& load = get_workload(n, width);
+   for(auto _ : state) {
+      state.PauseTiming();
+      std::unique_ptr<map_type> map = make(width);
+      fill(*map, load.keys);
+      state.ResumeTiming();
+      for(const uint64_t key : load.queries) { map->erase(key); }
+      benchmark::DoNotOptimize(map->size());
+      state.PauseTiming();
+      map.reset();
+      state.ResumeTiming();
+   }
+   state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class map_type>
+void bm_iterate(benchmark::State& state, const map_factory<map_type>& make, const unsigned width, const size_t n) {
+   const workload& load = get_workload(n, width);
+   std::unique_ptr<map_type> map = make(width);
+   fill(*map, load.keys);
+   for(auto _ : state) {
+      uint64_t sum = 0;
+      for(auto it = map->cbegin(); it != map->cend(); ++it) { sum += it->second; }
+      benchmark::DoNotOptimize(sum);
+   }
+   state.SetItemsProcessed(state.iterations() * n);
+}
+
+//! serializes the table and deserializes it into a new table
+template<class map_type>
+void bm_serialize(benchmark::State& state, const map_factory<map_type>& make, const unsigned width, const size_t n) {
+   const workload& load = get_workload(n, width);
+   std::unique_ptr<map_type> map = make(width);
+   fill(*map, load.keys);
+   size_t bytes = 0;
+   for(auto _ : state) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+      map->serialize(ss);
+      bytes += ss.tellp();
+      std::unique_ptr<map_type> copy = make(width);
+      copy->deserialize(ss);
+      if(copy->size() != map->size()) { state.SkipWithError("deserialized table differs"); }
+      state.PauseTiming();
+      copy.reset();
+      state.ResumeTiming();
+   }
+   state.SetItemsProcessed(state.iterations() * n);
+   state.SetBytesProcessed(bytes);
+}
+
+/**
+ * Registers the operations `operations` of the table created by `make` for each key width of `widths`,
+ * and for each number of elements 10^min_log10, ..., 10^max_log10 that leaves as many absent keys of this width for the negative lookups.
+ * Widths too small for 10^min_log10 elements are benchmarked with half of their keys.
+ * The benchmarks are named `name/operation/width/elements`.
+ * Iteration and serialization are skipped for tables not providing them.
+ */
+template<class map_type>
+void register_map(const std::string& name, const map_factory<map_type>& make, const std::vector<unsigned>& widths, const unsigned operations = op_all, const size_t max_log10 = SEPARATE_BENCH_MAX_LOG10) {
+   for(const unsigned width : widths) {
+      size_t n = 1;
+      for(size_t i = 0; i < min_log10; ++i) { n *= 10; }
+      for(size_t log10 = min_log10; log10 <= max_log10; ++log10, n *= 10) {
+         if(width < 64 && n > (1ULL<<(width-1))) { // too few keys of this width: only benchmark half of them, once
+            if(log10 > min_log10) { break; }
+            n = 1ULL<<(width-1);
+            log10 = max_log10;
+         }
+         const std::string suffix = "/" + std::to_string(width) + "/" + std::to_string(n);
+         if(operations & op_insert)        { benchmark::RegisterBenchmark((name + "/insert" + suffix).c_str(), bm_insert<map_type>, make, width, n); }
+         if(operations & op_find_positive) { benchmark::RegisterBenchmark((name + "/find_positive" + suffix).c_str(), bm_find<map_type>, make, width, n, true); }
+         if(operations & op_find_negative) { benchmark::RegisterBenchmark((name + "/find_negative" + suffix).c_str(), bm_find<map_type>, make, width, n, false); }
+         if(operations & op_erase)         { benchmark::RegisterBenchmark((name + "/erase" + suffix).c_str(), bm_erase<map_type>, make, width, n); }
+         if constexpr(is_iterable<map_type>::value) {
+            if(operations & op_iterate)    { benchmark::RegisterBenchmark((name + "/iterate" + suffix).c_str(), bm_iterate<map_type>, make, width, n); }
+         }
+         if constexpr(is_serializable<map_type>::value) {
+            if(operations & op_serialize)  { benchmark::RegisterBenchmark((name + "/serialize" + suffix).c_str(), bm_serialize<map_type>, make, width, n); }
+         }
+      }
+   }
+}
+
+//! creates a table with the key width given to the factory
+template<class map_type>
+std::unique_ptr<map_type> make_with_width(const unsigned width) { return std::make_unique<map_type>(width); }
+
+//! creates a table whose key width is fixed by its types
+template<class map_type>
+std::unique_ptr<map_type> make_default(const unsigned) { return std::make_unique<map_type>(); }
+
+/**
+ * Registers `separate_chaining_map` with the key bucket `key_bucket_t`, values in a `plain_bucket<uint32_t>`,
+ * and each combination of the hash mappings `hash_mapping_adapter<SplitMix>` and `xorshift_hash` with the resize strategies `incremental_resize` and `arbitrary_resize`.
+ */
+template<class key_bucket_t>
+void register_separate(const std::string& name, const std::vector<unsigned>& widths) {
+   using storage_type = typename key_bucket_t::storage_type;
+   using value_bucket_type = plain_bucket<uint32_t>;
+   using splitmix_type = hash_mapping_adapter<storage_type, SplitMix>;
+   using xorshift_type = xorshift_hash<storage_type>;
+   register_map<separate_chaining_map<key_bucket_t, value_bucket_type, splitmix_type, incremental_resize>>(name + "_SplitMix_incremental", make_with_width<separate_chaining_map<key_bucket_t, value_bucket_type, splitmix_type, incremental_resize>>, widths);
+   register_map<separate_chaining_map<key_bucket_t, value_bucket_type, splitmix_type, arbitrary_resize>>(name + "_SplitMix_arbitrary", make_with_width<separate_chaining_map<key_bucket_t, value_bucket_type, splitmix_type, arbitrary_resize>>, widths);
+   register_map<separate_chaining_map<key_bucket_t, value_bucket_type, xorshift_type, incremental_resize>>(name + "_Xor_incremental", make_with_width<separate_chaining_map<key_bucket_t, value_bucket_type, xorshift_type, incremental_resize>>, widths);
+   register_map<separate_chaining_map<key_bucket_t, value_bucket_type, xorshift_type, arbitrary_resize>>(name + "_Xor_arbitrary", make_with_width<separate_chaining_map<key_bucket_t, value_bucket_type, xorshift_type, arbitrary_resize>>, widths);
+}
+
+}//ns micro
+}//ns separate_chaining
@@ -0,0 +1,15 @@
+/**
+ * Microbenchmarks of `separate_chaining_map` with `avx2_bucket` keys, whose width is fixed by their integer type.
+ */
+#include "micro.hpp"
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+static const bool registered = [] {
+   register_separate<avx2_bucket<uint8_t>>("avx2_8", {8});
+   register_separate<avx2_bucket<uint16_t>>("avx2_16", {16});
+   register_separate<avx2_bucket<uint32_t>>("avx2_32", {32});
+   register_separate<avx2_bucket<uint64_t>>("avx2_64", {64});
+   return true;
+}();
@@ -0,0 +1,19 @@
+/**
+ * Microbenchmarks of `separate_chaining_map` with `plain_bucket` and `class_bucket` keys, whose width is fixed by their integer type.
+ */
+#include "micro.hpp"
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+static const bool registered = [] {
+   register_separate<plain_bucket<uint8_t>>("plain_8", {8});
+   register_separate<plain_bucket<uint16_t>>("plain_16", {16});
+   register_separate<plain_bucket<uint32_t>>("plain_32", {32});
+   register_separate<plain_bucket<uint64_t>>("plain_64", {64});
+   register_separate<class_bucket<uint8_t>>("class_8", {8});
+   register_separate<class_bucket<uint16_t>>("class_16", {16});
+   register_separate<class_bucket<uint32_t>>("class_32", {32});
+   register_separate<class_bucket<uint64_t>>("class_64", {64});
+   return true;
+}();
@@ -0,0 +1,12 @@
+/**
+ * Microbenchmarks of `separate_chaining_map` with `varwidth_bucket` keys, sweeping the key width.
+ */
+#include "micro.hpp"
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+static const bool registered = [] {
+   register_separate<varwidth_bucket<>>("varwidth", {8, 16, 24, 32, 40, 48, 56, 64});
+   return true;
+}();
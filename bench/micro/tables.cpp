@@ -0,0 +1,34 @@
+/**
+ * Microbenchmarks of the other tables of this library, and of `std::unordered_map` as a baseline, sweeping the key width.
+ */
+#include "micro.hpp"
+#include <separate/compact_chaining_map.hpp>
+#include <separate/group_chaining.hpp>
+#include <separate/bucket_table.hpp>
+#include <separate/keysplit_adapter.hpp>
+
+#include <unordered_map>
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+static const std::vector<unsigned> widths { 8, 16, 32, 48, 64 };
+
+static const bool registered = [] {
+   using unordered_map_type = std::unordered_map<uint64_t, uint32_t>;
+   register_map<unordered_map_type>("std_unordered_map", make_default<unordered_map_type>, widths);
+
+   using compact_type = compact_chaining_map<xorshift_hash<>>;
+   register_map<compact_type>("compact_Xor", [] (const unsigned width) { return std::make_unique<compact_type>(width, 32); }, widths);
+
+   using group_type = group::group_chaining_table<>;
+   register_map<group_type>("group_Xor", [] (const unsigned width) { return std::make_unique<group_type>(width, 32); }, widths);
+
+   // a single bucket, whose linear scans restrict it to small numbers of elements
+   using bucket_table_type = bucket_table<varwidth_bucket<>, plain_bucket<uint32_t>, incremental_resize>;
+   register_map<bucket_table_type>("bucket_table_varwidth", make_with_width<bucket_table_type>, widths, op_all, 4);
+
+   using keysplit_type = keysplit_adapter<separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, hash_mapping_adapter<uint64_t, SplitMix>>>;
+   register_map<keysplit_type>("keysplit_varwidth_SplitMix", make_default<keysplit_type>, widths);
+   return true;
+}();
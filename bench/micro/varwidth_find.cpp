@@ -0,0 +1,87 @@
+/**
+ * Microbenchmarks of the search in a single `varwidth_bucket` for each quotient width.
+ * It compares the broadword search, the AVX2 kernel `simd::find_packed_avx2`, and, as a reference, the AVX2 search of 32-bit quotients stored in a plain array, as done by `avx2_bucket<uint32_t>`.
+ * The benchmarks are named `varwidth_find/<variant>/<width>/<bucket length>`.
+ */
+#include "micro.hpp"
+
+using namespace separate_chaining;
+using namespace separate_chaining::micro;
+
+static const std::vector<unsigned> widths = { 9, 12, 16, 20, 24, 28, 30, 32 };
+static const std::vector<size_t> bucket_lengths = { 16, 64, 255 };
+
+/**
+ * A bucket with `length` distinct `width`-bit quotients, the same quotients bit-packed in `packed` as stored by `varwidth_bucket` and as a plain array,
+ * and 4096 queries, of which about 1/(length+1) miss.
+ */
+struct packed_workload {
+   const size_t length;
+   const unsigned width;
+   varwidth_bucket<> bucket;
+   std::vector<uint64_t> packed;
+   std::vector<uint32_t> plain;
+   std::vector<uint64_t> queries;
+
+   packed_workload(const size_t m_length, const unsigned m_width) : length(m_length), width(m_width), packed(ceil_div<size_t>(m_length*m_width, 64)+1), plain(m_length), queries(4096) {
+      bucket.initialize(length, width);
+      for(size_t i = 0; i < length; ++i) {
+         plain[i] = static_cast<uint32_t>(scramble(i, width));
+         bucket.write(i, plain[i], width);
+         tdc::tdc_sdsl::bits_impl<>::write_int(packed.data() + (i*width)/64, plain[i], (i*width)%64, width);
+      }
+      std::mt19937_64 generator(length);
+      std::uniform_int_distribution<size_t> position(0, length);
+      for(uint64_t& query : queries) { // position `length` is a key that is not stored
+         query = scramble(position(generator), width);
+      }
+   }
+};
+
+template<class search_type>
+void run_queries(benchmark::State& state, const packed_workload& load, search_type&& search) {
+   size_t found = 0;
+   for(auto _ : state) {
+      for(const uint64_t query : load.queries) { found += search(query) != -1ULL; }
+      benchmark::DoNotOptimize(found);
+   }
+   state.SetItemsProcessed(state.iterations() * load.queries.size());
+}
+
+void bm_bucket(benchmark::State& state, const unsigned width, const size_t length) {
+   const packed_workload load(length, width);
+   run_queries(state, load, [&](const uint64_t query) { return load.bucket.find(query, length, width); });
+}
+
+void bm_broadword(benchmark::State& state, const unsigned width, const size_t length) {
+   const packed_workload load(length, width);
+   const uint64_t* data = load.packed.data();
+   run_queries(state, load, [&](const uint64_t query) { return broadwordsearch::broadsearch(data, length, width, query); });
+}
+
+void bm_avx2(benchmark::State& state, const unsigned width, const size_t length) {
+   const packed_workload load(length, width);
+   const uint8_t* data = reinterpret_cast<const uint8_t*>(load.packed.data());
+   run_queries(state, load, [&](const uint64_t query) { return simd::find_packed_avx2(data, length, width, query); });
+}
+
+void bm_plain32(benchmark::State& state, const unsigned width, const size_t length) {
+   const packed_workload load(length, width);
+   const uint32_t* data = load.plain.data();
+   run_queries(state, load, [&](const uint64_t query) { return simd::find_avx2<uint32_t>(data, length, static_cast<uint32_t>(query)); });
+}
+
+static const bool registered = [] {
+   for(const unsigned width : widths) {
+      for(const size_t length : bucket_lengths) {
+         const std::string suffix = "/" + std::to_string(width) + "/" + std::to_string(length);
+         benchmark::RegisterBenchmark(("varwidth_find/broadword" + suffix).c_str(), bm_broadword, width, length);
+         benchmark::RegisterBenchmark(("varwidth_find/varwidth_bucket" + suffix).c_str(), bm_bucket, width, length);
+         if(simd::supported(simd::isa::avx2)) {
+            benchmark::RegisterBenchmark(("varwidth_find/avx2" + suffix).c_str(), bm_avx2, width, length);
+            benchmark::RegisterBenchmark(("varwidth_find/plain32_avx2" + suffix).c_str(), bm_plain32, width, length);
+         }
+      }
+   }
+   return true;
+}();
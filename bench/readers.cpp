@@ -0,0 +1,80 @@
+/**
+ * Measures the lookup throughput of 1 up to 64 threads querying a shared hash table without any locking.
+ * Since the const member functions of the hash tables do not modify any state, readers scale without synchronization.
+ *
+ * usage: bench_readers [number of elements] [maximum number of threads]
+ */
+#include <separate/separate_chaining_table.hpp>
+#include <separate/group_chaining.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+using value_type = uint64_t;
+
+template<class T>
+void run(const std::string& name, T& map, const std::vector<key_type>& keys, const size_t threads) {
+   const T& const_map = map;
+   const size_t elements = keys.size();
+   std::vector<size_t> found(threads);
+   std::vector<std::thread> workers;
+   const auto start = std::chrono::steady_clock::now();
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] () {
+         std::mt19937_64 generator(t);
+         for(size_t i = 0; i < elements; ++i) {
+            found[t] += const_map.find(keys[generator() % elements]) != const_map.cend();
+         }
+      });
+   }
+   for(auto& worker : workers) { worker.join(); }
+   const double find_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   for(size_t t = 0; t < threads; ++t) {
+      if(found[t] != elements) { std::cerr << "missing keys!" << std::endl; }
+   }
+   std::cout << "RESULT"
+      << " type=" << name
+      << " threads=" << threads
+      << " elements=" << elements
+      << " find_time=" << find_time
+      << " find_mops=" << (threads * elements / find_time / 1e6)
+      << std::endl;
+}
+
+template<class T>
+void run_all(const std::string& name, T& map, const std::vector<key_type>& keys, const size_t max_threads) {
+   for(size_t i = 0; i < keys.size(); ++i) { map[keys[i]] = i; }
+   for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+      run(name, map, keys, threads);
+   }
+}
+
+int main(int argc, char** argv) {
+   const size_t elements = argc > 1 ? std::stoull(argv[1]) : 1ULL<<22;
+   const size_t max_threads = argc > 2 ? std::stoull(argv[2]) : 64;
+
+   std::vector<key_type> keys(elements);
+   std::mt19937_64 generator(1);
+   for(auto& key : keys) { key = generator() & ((1ULL<<48)-1); }
+
+   {
+      separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>> map;
+      run_all("plain", map, keys, max_threads);
+   }
+   {
+      separate_chaining_map<varwidth_bucket<>, plain_bucket<value_type>, xorshift_hash<key_type>> map(48);
+      run_all("varwidth", map, keys, max_threads);
+   }
+   {
+      group::group_chaining_table<> map(48, 64);
+      run_all("group", map, keys, max_threads);
+   }
+   return 0;
+}
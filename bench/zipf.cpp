@@ -0,0 +1,93 @@
+/**
+ * Counts the frequencies of Zipfian distributed keys with different growth policies, and reports the throughput and the space of each table.
+ * The keys are either scrambled, or multiples of 64 hashed by the identity, which clusters them in few buckets like a weak hash function would do.
+ *
+ * usage: bench_zipf [number of updates] [number of distinct keys] [Zipf exponent]
+ */
+#include <separate/separate_chaining_table.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace separate_chaining;
+
+using key_type = uint64_t;
+using value_type = uint32_t;
+
+//! keeps the order of the keys such that keys sharing their lowest bits fall into the same bucket
+struct identity_hash {
+   uint64_t operator()(const uint64_t& x) const { return x; }
+};
+
+template<class T>
+void run(const std::string& name, const std::string& keys_name, const growth_policy& policy, const std::vector<key_type>& keys) {
+   T map;
+   map.growth(policy);
+   const auto start = std::chrono::steady_clock::now();
+   for(const key_type key : keys) {
+      map.upsert(key, 1, std::plus<value_type>());
+   }
+   const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "RESULT"
+      << " type=" << name
+      << " keys=" << keys_name
+      << " updates=" << keys.size()
+      << " distinct=" << map.size()
+      << " time=" << time
+      << " mops=" << (keys.size() / time / 1e6)
+      << " bucket_count=" << map.bucket_count()
+      << " overflow=" << map.m_overflow.size()
+      << " bytes=" << map.size_in_bytes()
+      << " bytes_per_element=" << (static_cast<double>(map.size_in_bytes()) / map.size())
+      << std::endl;
+}
+
+template<class T>
+void run_policies(const std::string& keys_name, const std::vector<key_type>& keys) {
+   growth_policy full_bucket; // grows on the first full bucket
+   run<T>("full_bucket", keys_name, full_bucket, keys);
+
+   growth_policy load;
+   load.max_load_factor = 8;
+   load.bucket_cap = 64;
+   load.hot_load_factor = 8;
+   run<T>("load_8_cap_64_hot", keys_name, load, keys);
+
+   growth_policy hot;
+   hot.bucket_cap = 32;
+   hot.hot_load_factor = 16;
+   run<T>("cap_32_hot_16", keys_name, hot, keys);
+}
+
+int main(int argc, char** argv) {
+   const size_t updates = argc > 1 ? std::stoull(argv[1]) : 1ULL<<24;
+   const size_t distinct = argc > 2 ? std::stoull(argv[2]) : 1ULL<<22;
+   const double exponent = argc > 3 ? std::stod(argv[3]) : 1.0;
+
+   //! samples ranks of a Zipf distribution by a binary search on its cumulative distribution
+   std::vector<double> cumulative(distinct);
+   double sum = 0;
+   for(size_t rank = 0; rank < distinct; ++rank) {
+      sum += 1.0 / std::pow(rank+1, exponent);
+      cumulative[rank] = sum;
+   }
+   std::mt19937_64 generator(1);
+   std::uniform_real_distribution<double> uniform(0, sum);
+   std::vector<size_t> ranks(updates);
+   for(auto& rank : ranks) {
+      rank = std::min<size_t>(distinct-1, std::lower_bound(cumulative.begin(), cumulative.end(), uniform(generator)) - cumulative.begin());
+   }
+
+   std::vector<key_type> keys(updates);
+   for(size_t i = 0; i < updates; ++i) { keys[i] = SplitMix()(ranks[i]) & ((1ULL<<48)-1); }
+   run_policies<separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, SplitMix>, incremental_resize, array_overflow>>("scrambled", keys);
+
+   for(size_t i = 0; i < updates; ++i) { keys[i] = ranks[i] << 6; }
+   run_policies<separate_chaining_map<plain_bucket<key_type>, plain_bucket<value_type>, hash_mapping_adapter<key_type, identity_hash>, incremental_resize, array_overflow>>("aligned", keys);
+   return 0;
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "math.hpp"
+#include "dcheck.hpp"
+
+namespace separate_chaining {
+
+//! memory statistics of an allocator
+struct allocator_stats {
+    size_t slabs = 0; //! number of slabs currently held
+    size_t reserved_bytes = 0; //! bytes obtained from the system
+    size_t used_bytes = 0; //! bytes handed out to buckets, rounded up to the size class
+
+    //! ratio of reserved bytes that are not handed out, between 0 and 1
+    double fragmentation() const {
+        return reserved_bytes == 0 ? 0 : 1.0 - static_cast<double>(used_bytes) / reserved_bytes;
+    }
+};
+
+/**
+ * Allocator policy of the buckets in `bucket.hpp`.
+ * An allocator provides `allocate`, `reallocate` and a static `deallocate`, such that
+ * a bucket can free its memory without knowing the allocator that provided it.
+ * This allocator forwards to `malloc`/`realloc`/`free`.
+ */
+struct malloc_allocator {
+    //! the instance buckets use when not given an allocator
+    static malloc_allocator& instance() {
+        static malloc_allocator allocator;
+        return allocator;
+    }
+
+    static void* allocate(const size_t bytes, const size_t alignment = alignof(std::max_align_t)) {
+        if(alignment <= alignof(std::max_align_t)) { return malloc(bytes); }
+        return aligned_alloc(alignment, ceil_div<size_t>(bytes, alignment)*alignment);
+    }
+
+    static void* reallocate(void*const ptr, const size_t old_bytes, const size_t bytes, const size_t alignment = alignof(std::max_align_t)) {
+        if(alignment <= alignof(std::max_align_t)) { return realloc(ptr, bytes); }
+        void*const new_ptr = allocate(bytes, alignment);
+        if(ptr != nullptr) {
+            memcpy(new_ptr, ptr, std::min(old_bytes, bytes));
+            free(ptr);
+        }
+        return new_ptr;
+    }
+
+    static void deallocate(void*const ptr) { free(ptr); }
+
+    static constexpr void clear() {}
+    static constexpr allocator_stats stats() { return {}; }
+};
+
+
+/**
+ * Allocator handing out memory of a fixed set of size classes, carved out of slabs of `SLAB_SIZE` bytes.
+ * Since buckets store at most `std::numeric_limits<bucketsize_type>::max()` elements, a bucket nearly always fits into one of the size classes.
+ * Compared to `malloc`, a chunk has no per-allocation header, which matters for buckets with only a few elements.
+ *
+ * Each slab is aligned to `SLAB_SIZE` and starts with a header, such that the slab of a chunk is found by rounding down the chunk's address.
+ * Larger requests obtain a dedicated block aligned to `SLAB_SIZE` with the same header.
+ * Slabs that become empty are returned to the system, except the last slab of a size class.
+ * The instance owns its slabs, and needs to outlive the memory it hands out.
+ */
+class slab_allocator {
+    public:
+    static constexpr size_t SLAB_SIZE = 1ULL<<16; //! size and alignment of a slab in bytes
+    static constexpr size_t MAX_CHUNK_SIZE = 2048; //! largest size class in bytes, suffices for 255 elements of 8 bytes
+    static constexpr size_t SLACK_SIZE = 8; //! unused bytes at the end of a slab, since `varwidth_bucket` accesses whole 64-bit words
+
+    private:
+    struct size_class;
+    struct pool;
+
+    struct slab_header {
+        size_class* owner; //! size class of the slab, nullptr for a block storing a single large chunk
+        pool* block_pool; //! pool of a block storing a single large chunk
+        slab_header* previous; //! neighbors in the list of slabs of `owner` with unused chunks
+        slab_header* next;
+        void* free_chunks; //! singly-linked list of freed chunks
+        char* unused; //! beginning of the chunks never handed out
+        size_t live; //! number of chunks handed out
+        size_t block_size; //! number of bytes of a block storing a single large chunk
+    };
+    static constexpr size_t HEADER_SIZE = ceil_div<size_t>(sizeof(slab_header), 64)*64; //! keeps the first chunk aligned to 64 bytes
+    static_assert(HEADER_SIZE + MAX_CHUNK_SIZE + SLACK_SIZE <= SLAB_SIZE, "a slab must store at least one chunk");
+
+    struct size_class {
+        size_t chunk_size = 0;
+        slab_header* available = nullptr; //! slabs with unused chunks
+        size_t slabs = 0;
+        size_t live = 0; //! number of chunks handed out
+    };
+
+    /**
+     * size classes are spaced by 8 bytes up to 128 bytes, by 32 bytes up to 512 bytes, and by 128 bytes up to `MAX_CHUNK_SIZE`.
+     * All classes of at least 32 bytes are multiples of 32, such that rounding up a request to its alignment yields an aligned chunk.
+     */
+    static constexpr size_t NUM_CLASSES = 128/8 + (512-128)/32 + (MAX_CHUNK_SIZE-512)/128;
+
+    static constexpr size_t class_index(const size_t bytes) {
+        if(bytes <= 128) { return bytes <= 8 ? 0 : ceil_div<size_t>(bytes, 8) - 1; }
+        if(bytes <= 512) { return 128/8 + ceil_div<size_t>(bytes-128, 32) - 1; }
+        return 128/8 + (512-128)/32 + ceil_div<size_t>(bytes-512, 128) - 1;
+    }
+    static constexpr size_t class_size(const size_t index) {
+        if(index < 128/8) { return (index+1)*8; }
+        if(index < 128/8 + (512-128)/32) { return 128 + (index+1 - 128/8)*32; }
+        return 512 + (index+1 - 128/8 - (512-128)/32)*128;
+    }
+
+    struct pool {
+        size_class classes[NUM_CLASSES];
+        size_t large_blocks = 0;
+        size_t large_bytes = 0;
+
+        pool() {
+            for(size_t i = 0; i < NUM_CLASSES; ++i) { classes[i].chunk_size = class_size(i); }
+        }
+        ~pool() { clear(); }
+
+        void clear() {
+            for(size_t i = 0; i < NUM_CLASSES; ++i) {
+                DDCHECK_EQ(classes[i].live, 0);
+                while(classes[i].available != nullptr) {
+                    slab_header*const slab = classes[i].available;
+                    unlink(slab);
+                    free(slab);
+                }
+                DDCHECK_EQ(classes[i].slabs, 0);
+            }
+            DDCHECK_EQ(large_blocks, 0);
+        }
+    };
+
+    std::unique_ptr<pool> m_pool;
+
+    //! chunks are aligned to 8 bytes; a larger alignment is obtained by rounding up to a size class that is a multiple of the alignment
+    static size_t request_size(const size_t bytes, const size_t alignment) {
+        return alignment <= sizeof(void*) ? std::max<size_t>(bytes, 1) : ceil_div<size_t>(std::max<size_t>(bytes, 1), alignment)*alignment;
+    }
+
+    static slab_header* slab_of(void*const ptr) {
+        return reinterpret_cast<slab_header*>(reinterpret_cast<uintptr_t>(ptr) & ~(SLAB_SIZE-1));
+    }
+
+    static bool is_full(const slab_header*const slab) {
+        return slab->free_chunks == nullptr && slab->unused + slab->owner->chunk_size + SLACK_SIZE > reinterpret_cast<const char*>(slab) + SLAB_SIZE;
+    }
+
+    static void link(slab_header*const slab) {
+        size_class& owner = *slab->owner;
+        slab->previous = nullptr;
+        slab->next = owner.available;
+        if(owner.available != nullptr) { owner.available->previous = slab; }
+        owner.available = slab;
+        ++owner.slabs;
+    }
+
+    static void unlink(slab_header*const slab) {
+        size_class& owner = *slab->owner;
+        if(slab->previous != nullptr) { slab->previous->next = slab->next; }
+        else { owner.available = slab->next; }
+        if(slab->next != nullptr) { slab->next->previous = slab->previous; }
+        slab->previous = slab->next = nullptr;
+        --owner.slabs;
+    }
+
+    void* allocate_large(const size_t bytes) {
+        const size_t block_size = ceil_div<size_t>(HEADER_SIZE + bytes + SLACK_SIZE, SLAB_SIZE)*SLAB_SIZE;
+        slab_header*const block = reinterpret_cast<slab_header*>(aligned_alloc(SLAB_SIZE, block_size));
+        if(block == nullptr) { throw std::bad_alloc(); }
+        block->owner = nullptr;
+        block->block_size = block_size;
+        block->block_pool = m_pool.get();
+        ++m_pool->large_blocks;
+        m_pool->large_bytes += block_size;
+        return reinterpret_cast<char*>(block) + HEADER_SIZE;
+    }
+
+    public:
+    slab_allocator() = default;
+    slab_allocator(slab_allocator&&) = default;
+    slab_allocator& operator=(slab_allocator&&) = default;
+
+    void* allocate(size_t bytes, const size_t alignment = sizeof(void*)) {
+        DDCHECK_LE(alignment, 64);
+        if(!m_pool) { m_pool = std::make_unique<pool>(); }
+        bytes = request_size(bytes, alignment);
+        if(bytes > MAX_CHUNK_SIZE) { return allocate_large(bytes); }
+
+        size_class& owner = m_pool->classes[class_index(bytes)];
+        DDCHECK_GE(owner.chunk_size, bytes);
+        slab_header* slab = owner.available;
+        if(slab == nullptr) {
+            slab = reinterpret_cast<slab_header*>(aligned_alloc(SLAB_SIZE, SLAB_SIZE));
+            if(slab == nullptr) { throw std::bad_alloc(); }
+            slab->owner = &owner;
+            slab->free_chunks = nullptr;
+            slab->unused = reinterpret_cast<char*>(slab) + HEADER_SIZE;
+            slab->live = 0;
+            slab->block_size = SLAB_SIZE;
+            link(slab);
+        }
+        void* chunk;
+        if(slab->free_chunks != nullptr) {
+            chunk = slab->free_chunks;
+            slab->free_chunks = *reinterpret_cast<void**>(chunk);
+        } else {
+            chunk = slab->unused;
+            slab->unused += owner.chunk_size;
+        }
+        ++slab->live;
+        ++owner.live;
+        if(is_full(slab)) { unlink(slab); ++owner.slabs; } //! a full slab is not linked, but still counted
+        DDCHECK(slab_of(chunk) == slab);
+        return chunk;
+    }
+
+    void* reallocate(void*const ptr, const size_t old_bytes, const size_t bytes, const size_t alignment = sizeof(void*)) {
+        if(ptr == nullptr) { return allocate(bytes, alignment); }
+        const slab_header*const slab = slab_of(ptr);
+        const size_t aligned_bytes = request_size(bytes, alignment);
+        if(slab->owner != nullptr && aligned_bytes <= MAX_CHUNK_SIZE && class_index(aligned_bytes) == class_index(slab->owner->chunk_size)) {
+            return ptr; //! same size class
+        }
+        void*const new_ptr = allocate(bytes, alignment);
+        memcpy(new_ptr, ptr, std::min(old_bytes, bytes));
+        deallocate(ptr);
+        return new_ptr;
+    }
+
+    //! returns a chunk to its slab, which is found by the address of the chunk
+    static void deallocate(void*const ptr) {
+        if(ptr == nullptr) { return; }
+        slab_header*const slab = slab_of(ptr);
+        if(slab->owner == nullptr) { //! large block
+            pool& owner = *slab->block_pool;
+            --owner.large_blocks;
+            owner.large_bytes -= slab->block_size;
+            free(slab);
+            return;
+        }
+        size_class& owner = *slab->owner;
+        DDCHECK_GT(slab->live, 0);
+        const bool was_full = is_full(slab);
+        *reinterpret_cast<void**>(ptr) = slab->free_chunks;
+        slab->free_chunks = ptr;
+        --slab->live;
+        --owner.live;
+        if(was_full) { --owner.slabs; link(slab); }
+        if(slab->live == 0 && !(owner.available == slab && slab->next == nullptr)) { //! keep the last slab with unused chunks
+            unlink(slab);
+            free(slab);
+        }
+    }
+
+    //! returns all slabs to the system. All memory handed out must have been deallocated.
+    void clear() {
+        if(m_pool) { m_pool->clear(); }
+    }
+
+    allocator_stats stats() const {
+        allocator_stats ret;
+        if(!m_pool) { return ret; }
+        for(size_t i = 0; i < NUM_CLASSES; ++i) {
+            const size_class& owner = m_pool->classes[i];
+            ret.slabs += owner.slabs;
+            ret.reserved_bytes += owner.slabs * SLAB_SIZE;
+            ret.used_bytes += owner.live * owner.chunk_size;
+        }
+        ret.slabs += m_pool->large_blocks;
+        ret.reserved_bytes += m_pool->large_bytes;
+        ret.used_bytes += m_pool->large_bytes;
+        return ret;
+    }
+};
+
+
+/**
+ * checks whether a bucket can be used with a table whose buckets are managed by `allocator_t`.
+ * Buckets without an `allocator_type`, or with `allocator_type` being `void`, manage their memory on their own.
+ */
+template<class bucket_t, class allocator_t, class = void>
+struct is_allocator_compatible : std::true_type {};
+
+template<class bucket_t, class allocator_t>
+struct is_allocator_compatible<bucket_t, allocator_t, std::void_t<typename bucket_t::allocator_type>>
+    : std::integral_constant<bool, std::is_void<typename bucket_t::allocator_type>::value || std::is_same<typename bucket_t::allocator_type, allocator_t>::value> {};
+
+}//ns separate_chaining
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "dcheck.hpp"
+
+namespace separate_chaining {
+
+/**
+ * Bit-granular counterparts of `memcpy` and `memmove` on arrays of bit-packed integers,
+ * whose bit `i` is bit `i mod 8` of byte `i/8`, i.e., the layout written by `tdc::tdc_sdsl::bits_impl` on little-endian machines.
+ * In contrast to `bits_impl`, these functions never access a byte that does not contain an accessed bit,
+ * such that an array of `ceil(bits/8)` bytes suffices.
+ */
+
+//! reads the `n <= 8` bytes starting at `byte` as a little-endian integer, with at most two loads
+inline uint64_t load_bytes(const uint8_t* byte, const uint_fast8_t n) {
+   if(n == 8) { uint64_t word; std::memcpy(&word, byte, 8); return word; }
+   if(n >= 4) { // two overlapping 32-bit loads
+      uint32_t low;
+      uint32_t high;
+      std::memcpy(&low, byte, 4);
+      std::memcpy(&high, byte + n - 4, 4);
+      return low | (static_cast<uint64_t>(high) << (8*(n-4)));
+   }
+   if(n == 0) { return 0; }
+   return byte[0] | (static_cast<uint64_t>(byte[n/2]) << (8*(n/2))) | (static_cast<uint64_t>(byte[n-1]) << (8*(n-1)));
+}
+
+//! writes the lowest `n <= 8` bytes of `word` to `byte` in little-endian order, with at most three stores
+inline void store_bytes(uint8_t* byte, const uint_fast8_t n, const uint64_t word) {
+   if(n == 8) { std::memcpy(byte, &word, 8); return; }
+   if(n >= 4) {
+      const uint32_t low = word;
+      const uint32_t high = word >> (8*(n-4));
+      std::memcpy(byte, &low, 4);
+      std::memcpy(byte + n - 4, &high, 4);
+      return;
+   }
+   if(n == 0) { return; }
+   byte[0] = word;
+   byte[n/2] = word >> (8*(n/2));
+   byte[n-1] = word >> (8*(n-1));
+}
+
+//! reads the `n <= 64` bits starting at bit `position` of `data`
+inline uint64_t read_bits(const uint8_t* data, const uint64_t position, const uint_fast8_t n) {
+   DDCHECK_LE(n, 64);
+   if(n == 0) { return 0; }
+   const uint8_t* byte = data + position/8;
+   const uint_fast8_t shift = position % 8;
+   const uint_fast8_t bytes = (shift + n + 7)/8; // at most 9
+   uint64_t word = load_bytes(byte, bytes < 8 ? bytes : 8) >> shift;
+   if(bytes > 8) { word |= static_cast<uint64_t>(byte[8]) << (64 - shift); }
+   return n == 64 ? word : word & ((1ULL<<n)-1);
+}
+
+//! overwrites the `n <= 64` bits starting at bit `position` of `data` with the lowest `n` bits of `value`
+inline void write_bits(uint8_t* data, const uint64_t position, const uint_fast8_t n, const uint64_t value) {
+   DDCHECK_LE(n, 64);
+   if(n == 0) { return; }
+   uint8_t* byte = data + position/8;
+   const uint_fast8_t shift = position % 8;
+   const uint_fast8_t bytes = (shift + n + 7)/8; // at most 9
+   const uint64_t mask = n == 64 ? -1ULL : (1ULL<<n)-1;
+   const uint_fast8_t low_bytes = bytes < 8 ? bytes : 8;
+   const uint64_t word = load_bytes(byte, low_bytes);
+   store_bytes(byte, low_bytes, (word & ~(mask << shift)) | ((value & mask) << shift));
+   if(bytes > 8) {
+      const uint_fast8_t high_bits = shift + n - 64; // bits of the ninth byte
+      const uint8_t high_mask = (1U<<high_bits)-1;
+      byte[8] = (byte[8] & ~high_mask) | (static_cast<uint8_t>((value & mask) >> (64 - shift)) & high_mask);
+   }
+}
+
+//! reads 64 bits starting at bit `shift < 8` of `byte` with two overlapping unaligned loads, whose bits agree where they overlap
+inline uint64_t read_shifted_word(const uint8_t* byte, const uint_fast8_t shift) {
+   uint64_t low;
+   uint64_t high;
+   std::memcpy(&low, byte, 8);
+   if(shift == 0) { return low; }
+   std::memcpy(&high, byte+1, 8);
+   return (low >> shift) | (high << (8 - shift));
+}
+
+/**
+ * Moves the `bits` bits starting at bit `from` of `data` to bit `to`, where source and destination may overlap.
+ * The bits of `data` outside of `[to, to+bits)` stay unchanged.
+ * After moving at most 7 bits to make the destination byte-aligned, it moves 64 bits per step, each with two loads funnel-shifted by the constant offset of the source,
+ * and one unaligned store. If source and destination have the same offset within a byte, these steps are a single `memmove`.
+ */
+inline void move_bits(uint8_t* data, const uint64_t to, const uint64_t from, uint64_t bits) {
+   if(bits == 0 || to == from) { return; }
+   if(bits < 64) { // source and destination fit into one word each
+      write_bits(data, to, bits, read_bits(data, from, bits));
+      return;
+   }
+   if(to < from) { // copy from low to high addresses
+      const uint_fast8_t head = (8 - to % 8) % 8;
+      write_bits(data, to, head, read_bits(data, from, head));
+      uint64_t write = to + head; // byte-aligned
+      uint64_t read = from + head;
+      bits -= head;
+      const uint_fast8_t shift = read % 8;
+      if(shift == 0) {
+         std::memmove(data + write/8, data + read/8, bits/8);
+         write += bits/8*8;
+         read += bits/8*8;
+         bits %= 8;
+      } else {
+         // funnel-shift consecutive source words, carrying the higher word to the next step; the last step reads only the bytes of the source range
+         uint64_t low = 0;
+         if(bits >= 128) { std::memcpy(&low, data + read/8, 8); }
+         for(; bits >= 128; bits -= 64, write += 64, read += 64) {
+            uint64_t high;
+            std::memcpy(&high, data + read/8 + 8, 8);
+            const uint64_t word = (low >> shift) | (high << (64 - shift));
+            std::memcpy(data + write/8, &word, 8);
+            low = high;
+         }
+         if(bits >= 64) {
+            const uint64_t word = read_shifted_word(data + read/8, shift);
+            std::memcpy(data + write/8, &word, 8);
+            bits -= 64; write += 64; read += 64;
+         }
+      }
+      write_bits(data, write, bits, read_bits(data, read, bits));
+   } else { // copy from high to low addresses
+      const uint_fast8_t tail = std::min<uint64_t>((to + bits) % 8, bits);
+      bits -= tail;
+      write_bits(data, to + bits, tail, read_bits(data, from + bits, tail));
+      // now `to + bits` is byte-aligned
+      const uint_fast8_t shift = (from + bits) % 8;
+      if(shift == 0) {
+         const uint64_t bytes = bits/8;
+         std::memmove(data + (to + bits)/8 - bytes, data + (from + bits)/8 - bytes, bytes);
+         bits %= 8;
+      } else {
+         // as above, but carrying the lower word; the source word of a step starts at byte (from + bits - 64)/8, and the last step reads only the bytes of the source range
+         uint64_t high = 0;
+         if(bits >= 128) { std::memcpy(&high, data + (from + bits - 64)/8 + 1, 8); }
+         for(; bits >= 128; bits -= 64) {
+            uint64_t low;
+            std::memcpy(&low, data + (from + bits - 64)/8 - 7, 8);
+            const uint64_t word = (high << (8 - shift)) | (low >> (56 + shift));
+            std::memcpy(data + (to + bits - 64)/8, &word, 8);
+            high = low;
+         }
+         if(bits >= 64) {
+            const uint64_t word = read_shifted_word(data + (from + bits - 64)/8, shift);
+            std::memcpy(data + (to + bits - 64)/8, &word, 8);
+            bits -= 64;
+         }
+      }
+      write_bits(data, to, bits, read_bits(data, from, bits));
+   }
+}
+
+//! `move_bits` for arrays of wider integers, e.g., the `internal_type` of a bucket
+template<class internal_type>
+inline void move_bits(internal_type* data, const uint64_t to, const uint64_t from, const uint64_t bits) {
+   move_bits(reinterpret_cast<uint8_t*>(data), to, from, bits);
+}
+
+}//ns separate_chaining
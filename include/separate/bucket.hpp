@@ -1,9 +1,14 @@
 #pragma once
 
 #include "math.hpp"
+#include "allocator.hpp"
 #include <tudocomp/util/sdsl_bits.hpp>
 
 #include <immintrin.h>
+#include <type_traits>
+
+#include "simd.hpp"
+#include "bitmove.hpp"
 
 #include "broadwordsearch.hpp"
 #include "dcheck.hpp"
@@ -13,21 +18,6 @@ constexpr uint64_t BROADWORD_SEARCH_THRESHOLD = 0;
 
 namespace separate_chaining {
 
-inline void* aligned_realloc(void*const ptr, const size_t oldsize, const size_t size, const size_t alignment) {
-   DDCHECK_LE(oldsize, size);
-   void* newptr = _mm_malloc(size, alignment);
-
-   for(size_t i = 0; i < oldsize/sizeof(uint64_t); ++i) {
-      reinterpret_cast<uint64_t*>(newptr)[i] = reinterpret_cast<const uint64_t*>(ptr)[i];
-   }
-   for(size_t i = (oldsize/sizeof(uint64_t))*sizeof(uint64_t); i < oldsize; ++i) {
-      reinterpret_cast<uint8_t*>(newptr)[i] = reinterpret_cast<const uint8_t*>(ptr)[i];
-   }
-   DDCHECK(ptr != nullptr);
-   _mm_free(ptr);
-   return newptr;
-}
-
 #ifdef __AVX2__
 
 template<class storage_t>
@@ -64,10 +54,11 @@ struct avx_functions<uint8_t> {
 
 
 
-template<class storage_t>
+template<class storage_t, class allocator_t = malloc_allocator>
 class avx2_bucket {
     public:
     using storage_type = storage_t;
+    using allocator_type = allocator_t;
     ON_DEBUG(size_t m_length;)
 
     private:
@@ -76,9 +67,10 @@ class avx2_bucket {
 
     public:
     bool initialized() const { return m_data != nullptr; } //!check whether we can add elements to the bucket
+    void prefetch() const { __builtin_prefetch(m_data); } //! hint to load the beginning of the bucket into the cache
     void clear() {
         if(m_data != nullptr) {
-            _mm_free(m_data);
+            allocator_type::deallocate(m_data);
         }
         m_data = nullptr;
         ON_DEBUG(m_length = 0;)
@@ -86,19 +78,19 @@ class avx2_bucket {
 
     avx2_bucket() = default;
 
-    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width) {
+    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        DDCHECK(m_data == nullptr);
-        m_data = reinterpret_cast<storage_type*>  (_mm_malloc(sizeof(storage_type)*length, m_alignment));
+        m_data = reinterpret_cast<storage_type*>  (allocator.allocate(sizeof(storage_type)*length, m_alignment));
         ON_DEBUG(m_length = length;)
 #if defined(STATS_ENABLED) && !defined(MALLOC_DISABLED)
        throw std::runtime_error("Cannot use tudocomp stats in conjuction with avx2");
 #endif
     }
 
-    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width) {
+    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        ON_DEBUG(is.read(reinterpret_cast<char*>(&m_length), sizeof(decltype(m_length))));
        DDCHECK_LE(size, m_length);
-       initialize(size,width);
+       initialize(size, width, allocator);
        is.read(reinterpret_cast<char*>(m_data), sizeof(storage_type)*size);
     }
     void serialize(std::ostream& os, const size_t size, [[maybe_unused]] const uint_fast8_t width) const {
@@ -113,9 +105,9 @@ class avx2_bucket {
 
 
 
-    void resize(const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width) {
+    void resize(const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width, allocator_type& allocator = allocator_type::instance()) {
 
-        m_data = reinterpret_cast<storage_type*>  (aligned_realloc(m_data, sizeof(storage_type)*oldsize,  sizeof(storage_type)*size, m_alignment));
+        m_data = reinterpret_cast<storage_type*>  (allocator.reallocate(m_data, sizeof(storage_type)*oldsize,  sizeof(storage_type)*size, m_alignment));
         ON_DEBUG(m_length = size;)
     }
 
@@ -183,15 +175,213 @@ class avx2_bucket {
 #endif// __AVX2__
 
 
+#ifdef SEPARATE_X86_TARGETS
+/**
+ * Bucket storing 8/16/32/64-bit quotients, whose `find` compares 512 bits at once.
+ * The last chunk of a bucket is compared with a masked load instead of a scalar loop, such that a search runs `ceil(length/(64/sizeof(storage_t)))` iterations without a tail.
+ * The AVX-512 instructions are compiled with a target attribute, such that the bucket is available in any build for x86-64;
+ * `find` must only be called if `avx512_supported()` holds.
+ */
+template<class storage_t, class allocator_t = malloc_allocator>
+class avx512_bucket {
+    public:
+    using storage_type = storage_t;
+    using allocator_type = allocator_t;
+    ON_DEBUG(size_t m_length;)
 
+    private:
+    static constexpr size_t m_alignment = 64;
+    storage_type* m_data = nullptr; //!bucket for keys
 
+    public:
+    static bool supported() { return avx512_supported(); } //! whether `find` can be executed on the running CPU
+    bool initialized() const { return m_data != nullptr; } //!check whether we can add elements to the bucket
+    void prefetch() const { __builtin_prefetch(m_data); } //! hint to load the beginning of the bucket into the cache
+    void clear() {
+        if(m_data != nullptr) {
+            allocator_type::deallocate(m_data);
+        }
+        m_data = nullptr;
+        ON_DEBUG(m_length = 0;)
+    }
 
+    avx512_bucket() = default;
 
+    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
+        DDCHECK(m_data == nullptr);
+        m_data = reinterpret_cast<storage_type*>  (allocator.allocate(sizeof(storage_type)*length, m_alignment));
+        ON_DEBUG(m_length = length;)
+    }
 
-template<class storage_t>
+    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
+       ON_DEBUG(is.read(reinterpret_cast<char*>(&m_length), sizeof(decltype(m_length))));
+       DDCHECK_LE(size, m_length);
+       initialize(size, width, allocator);
+       is.read(reinterpret_cast<char*>(m_data), sizeof(storage_type)*size);
+    }
+    void serialize(std::ostream& os, const size_t size, [[maybe_unused]] const uint_fast8_t width) const {
+       ON_DEBUG(os.write(reinterpret_cast<const char*>(&m_length), sizeof(decltype(m_length))));
+       DDCHECK_LE(size, m_length);
+       os.write(reinterpret_cast<const char*>(m_data), sizeof(storage_type)*size);
+    }
+    static constexpr size_t size_in_bytes(const size_t size, [[maybe_unused]] const size_t width = 0) {
+       ON_DEBUG(return size*sizeof(storage_type) + sizeof(m_length));
+       return size*sizeof(storage_type);
+    }
+
+    void resize(const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width, allocator_type& allocator = allocator_type::instance()) {
+        m_data = reinterpret_cast<storage_type*>  (allocator.reallocate(m_data, sizeof(storage_type)*oldsize,  sizeof(storage_type)*size, m_alignment));
+        ON_DEBUG(m_length = size;)
+    }
+
+    void write(const size_t i, const storage_type& key, [[maybe_unused]] const uint_fast8_t width) {
+        DDCHECK_LT(i, m_length);
+        m_data[i] = key;
+    }
+    storage_type read(size_t i, [[maybe_unused]]  size_t width) const {
+        DDCHECK_LT(i, m_length);
+        return m_data[i];
+    }
+
+    void erase(const size_t position, const size_t length, [[maybe_unused]] const uint_fast8_t width) {
+       DDCHECK_LE(length, m_length);
+       DDCHECK_LT(position, m_length);
+       if(position+1 < length) {
+          memmove(m_data+position, m_data+position+1, sizeof(storage_type)*(length-position-1));
+       }
+    }
+
+    SEPARATE_TARGET_AVX512 size_t find(const storage_type& key, const size_t length, [[maybe_unused]] const size_t width = 0) const {
+       return simd::find_avx512<storage_type>(m_data, length, key);
+    }
+
+    ~avx512_bucket() { clear(); }
+
+    avx512_bucket(avx512_bucket&& other)
+        : m_data(std::move(other.m_data))
+    {
+        other.m_data = nullptr;
+        ON_DEBUG(m_length = other.m_length; other.m_length = 0;)
+    }
+
+    avx512_bucket& operator=(avx512_bucket&& other) {
+        clear();
+        m_data = std::move(other.m_data);
+        other.m_data = nullptr;
+        ON_DEBUG(m_length = other.m_length; other.m_length = 0;)
+        return *this;
+    }
+};
+
+#endif// SEPARATE_X86_TARGETS
+
+/**
+ * Bucket storing 8/16/32/64-bit quotients, whose `find` runs the fastest search kernel the running CPU supports (see `simd::best_isa()`).
+ * The kernel is chosen once per process, such that a single build runs the AVX-512 or AVX2 kernels on CPUs having them,
+ * and the SWAR or scalar kernels elsewhere, without needing `-march=native`.
+ * `erase` shifts the elements with `memmove`, whose implementation is already selected for the CPU by the C library.
+ * Since the kernels use unaligned loads, the bucket has the memory layout of `plain_bucket` and can be reallocated in place.
+ */
+template<class storage_t, class allocator_t = malloc_allocator>
+class dispatch_bucket {
+    public:
+    using storage_type = storage_t;
+    using allocator_type = allocator_t;
+    ON_DEBUG(size_t m_length;)
+
+    private:
+    storage_type* m_data = nullptr; //!bucket for keys
+
+    public:
+    bool initialized() const { return m_data != nullptr; } //!check whether we can add elements to the bucket
+    void prefetch() const { __builtin_prefetch(m_data); } //! hint to load the beginning of the bucket into the cache
+    void clear() {
+        if(m_data != nullptr) {
+            allocator_type::deallocate(m_data);
+        }
+        m_data = nullptr;
+        ON_DEBUG(m_length = 0;)
+    }
+
+    dispatch_bucket() = default;
+
+    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
+        DDCHECK(m_data == nullptr);
+        m_data = reinterpret_cast<storage_type*>  (allocator.allocate(sizeof(storage_type)*length, alignof(storage_type)));
+        ON_DEBUG(m_length = length;)
+    }
+
+    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
+       ON_DEBUG(is.read(reinterpret_cast<char*>(&m_length), sizeof(decltype(m_length))));
+       DDCHECK_LE(size, m_length);
+       initialize(size, width, allocator);
+       is.read(reinterpret_cast<char*>(m_data), sizeof(storage_type)*size);
+    }
+    void serialize(std::ostream& os, const size_t size, [[maybe_unused]] const uint_fast8_t width) const {
+       ON_DEBUG(os.write(reinterpret_cast<const char*>(&m_length), sizeof(decltype(m_length))));
+       DDCHECK_LE(size, m_length);
+       os.write(reinterpret_cast<const char*>(m_data), sizeof(storage_type)*size);
+    }
+    static constexpr size_t size_in_bytes(const size_t size, [[maybe_unused]] const size_t width = 0) {
+       ON_DEBUG(return size*sizeof(storage_type) + sizeof(m_length));
+       return size*sizeof(storage_type);
+    }
+
+    void resize(const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width, allocator_type& allocator = allocator_type::instance()) {
+        m_data = reinterpret_cast<storage_type*>  (allocator.reallocate(m_data, sizeof(storage_type)*oldsize,  sizeof(storage_type)*size, alignof(storage_type)));
+        ON_DEBUG(m_length = size;)
+    }
+
+    void write(const size_t i, const storage_type& key, [[maybe_unused]] const uint_fast8_t width) {
+        DDCHECK_LT(i, m_length);
+        m_data[i] = key;
+    }
+    storage_type read(size_t i, [[maybe_unused]]  size_t width) const {
+        DDCHECK_LT(i, m_length);
+        return m_data[i];
+    }
+
+    void erase(const size_t position, const size_t length, [[maybe_unused]] const uint_fast8_t width) {
+       DDCHECK_LE(length, m_length);
+       DDCHECK_LT(position, m_length);
+       if(position+1 < length) {
+          memmove(m_data+position, m_data+position+1, sizeof(storage_type)*(length-position-1));
+       }
+    }
+
+    size_t find(const storage_type& key, const size_t length, [[maybe_unused]] const size_t width = 0) const {
+       return simd::dispatched_find<storage_type>()(m_data, length, key);
+    }
+
+    ~dispatch_bucket() { clear(); }
+
+    dispatch_bucket(dispatch_bucket&& other)
+        : m_data(std::move(other.m_data))
+    {
+        other.m_data = nullptr;
+        ON_DEBUG(m_length = other.m_length; other.m_length = 0;)
+    }
+
+    dispatch_bucket& operator=(dispatch_bucket&& other) {
+        clear();
+        m_data = std::move(other.m_data);
+        other.m_data = nullptr;
+        ON_DEBUG(m_length = other.m_length; other.m_length = 0;)
+        return *this;
+    }
+};
+
+
+
+
+
+
+
+template<class storage_t, class allocator_t = malloc_allocator>
 class plain_bucket {
     public:
     using storage_type = storage_t;
+    using allocator_type = allocator_t;
     ON_DEBUG(size_t m_length;)
 
     protected:
@@ -199,10 +389,10 @@ class plain_bucket {
 
     public:
 
-    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width) {
+    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        ON_DEBUG(is.read(reinterpret_cast<char*>(&m_length), sizeof(decltype(m_length))));
        DDCHECK_LE(size, m_length);
-       initialize(size, width);
+       initialize(size, width, allocator);
        is.read(reinterpret_cast<char*>(m_data), sizeof(storage_type)*size);
     }
     void serialize(std::ostream& os, const size_t size, [[maybe_unused]] const uint_fast8_t width) const {
@@ -217,10 +407,11 @@ class plain_bucket {
 
 
     bool initialized() const { return m_data != nullptr; } //!check whether we can add elements to the bucket
+    void prefetch() const { __builtin_prefetch(m_data); } //! hint to load the beginning of the bucket into the cache
 
     void clear() {
         if(m_data != nullptr) {
-            free(m_data);
+            allocator_type::deallocate(m_data);
         }
         m_data = nullptr;
         ON_DEBUG(m_length = 0;)
@@ -237,9 +428,9 @@ class plain_bucket {
         return m_data[index];
     }
 
-    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width) {
+    void initialize(const size_t length, [[maybe_unused]] const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        DDCHECK(m_data == nullptr);
-       m_data = reinterpret_cast<storage_type*>  (malloc(sizeof(storage_type)*length));
+       m_data = reinterpret_cast<storage_type*>  (allocator.allocate(sizeof(storage_type)*length, alignof(storage_type)));
        ON_DEBUG(m_length = length;)
     }
 
@@ -250,8 +441,8 @@ class plain_bucket {
 #pragma GCC diagnostic ignored "-Wclass-memaccess"
 #endif
 // this function creates warnings when storage_type is a class wrapped around a POD
-    void resize([[maybe_unused]] const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width = 0) {
-        m_data = reinterpret_cast<storage_type*>  (realloc(m_data, sizeof(storage_type)*size));
+    void resize([[maybe_unused]] const size_t oldsize, const size_t size, [[maybe_unused]] const size_t width = 0, allocator_type& allocator = allocator_type::instance()) {
+        m_data = reinterpret_cast<storage_type*>  (allocator.reallocate(m_data, sizeof(storage_type)*oldsize, sizeof(storage_type)*size, alignof(storage_type)));
         ON_DEBUG(m_length = size;)
     }
 
@@ -275,11 +466,16 @@ class plain_bucket {
         DDCHECK_LT(i, m_length);
         return m_data[i];
     }
+    //! searches 8- and 16-bit integers with the portable SWAR kernel `simd::find_swar`, comparing 8 or 4 keys per 64-bit word
     size_t find(const storage_type& key, const size_t length, [[maybe_unused]] const size_t width = 0) const {
-       for(size_t i = 0; i < length; ++i) {
-          if(m_data[i] == key) return i;
+       if constexpr(std::is_integral_v<storage_type> && sizeof(storage_type) <= sizeof(uint16_t)) {
+          return simd::find_swar<storage_type>(m_data, length, key);
+       } else {
+          for(size_t i = 0; i < length; ++i) {
+             if(m_data[i] == key) return i;
+          }
+          return -1ULL;
        }
-       return -1ULL;
     }
 
     ~plain_bucket() { clear(); }
@@ -310,6 +506,7 @@ class class_bucket : public plain_bucket<storage_t> {
     public:
     using storage_type = typename plain_bucket<storage_t>::storage_type;
     using super_class = plain_bucket<storage_t>;
+    using allocator_type = void; //! allocates with `new[]` regardless of the allocator of the hash table
 
     public:
 
@@ -339,6 +536,21 @@ class class_bucket : public plain_bucket<storage_t> {
        ON_DEBUG(super_class::m_length = size);
     }
 
+    void deserialize(std::istream& is, const size_t size, [[maybe_unused]] const uint_fast8_t width) {
+       ON_DEBUG(is.read(reinterpret_cast<char*>(&this->m_length), sizeof(decltype(this->m_length))));
+       DDCHECK_LE(size, this->m_length);
+       initialize(size, width);
+       is.read(reinterpret_cast<char*>(super_class::m_data), sizeof(storage_type)*size);
+    }
+
+    //! the following overloads ignore the allocator of the hash table
+    template<class allocator_t>
+    void initialize(const size_t length, const uint_fast8_t width, allocator_t&) { initialize(length, width); }
+    template<class allocator_t>
+    void resize(const size_t oldsize, const size_t size, const size_t width, allocator_t&) { resize(oldsize, size, width); }
+    template<class allocator_t>
+    void deserialize(std::istream& is, const size_t size, const uint_fast8_t width, allocator_t&) { deserialize(is, size, width); }
+
     ~class_bucket() { clear(); }
 
     class_bucket(class_bucket&& other) 
@@ -361,12 +573,14 @@ class class_bucket : public plain_bucket<storage_t> {
 /**!
  * `internal_t` is a tradeoff between the number of mallocs and unused space, as it defines the block size in which elements are stored, 
  * i.e., its memory consuption is quantisized by this type's byte size
+ * `find` on fields of at most 32 bits uses `simd::find_packed_avx2` if the CPU supports AVX2, and the broadword search otherwise.
 **/
-template<class internal_t = uint8_t>
+template<class internal_t = uint8_t, class allocator_t = malloc_allocator>
 class varwidth_bucket {
     public:
     using internal_type = internal_t;
     using storage_type = uint64_t;
+    using allocator_type = allocator_t;
     static constexpr uint_fast8_t storage_bitwidth = sizeof(internal_type)*8;
     ON_DEBUG(size_t m_size;) //! number of entries of m_data
     ON_DEBUG(size_t m_length;) //! number of elements m_data can contain. 
@@ -376,13 +590,13 @@ class varwidth_bucket {
 
     public:
 
-    void deserialize(std::istream& is, const size_t size, const uint_fast8_t width) {
+    void deserialize(std::istream& is, const size_t size, const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        ON_DEBUG(is.read(reinterpret_cast<char*>(&m_size), sizeof(decltype(m_size))));
        ON_DEBUG(is.read(reinterpret_cast<char*>(&m_length), sizeof(decltype(m_length))));
        DDCHECK_LE(size, m_length);
        const size_t read_length = ceil_div<size_t>(size*width, storage_bitwidth);
        DDCHECK_LE(read_length, m_size);
-       m_data = reinterpret_cast<internal_type*>  (malloc(sizeof(internal_type)*read_length));
+       m_data = reinterpret_cast<internal_type*>  (allocator.allocate(sizeof(internal_type)*read_length, alignof(internal_type)));
        is.read(reinterpret_cast<char*>(m_data), sizeof(internal_type)*read_length);
     }
     void serialize(std::ostream& os, const size_t size, const uint_fast8_t width) const {
@@ -400,9 +614,10 @@ class varwidth_bucket {
     }
 
     bool initialized() const { return m_data != nullptr; } //!check whether we can add elements to the bucket
+    void prefetch() const { __builtin_prefetch(m_data); } //! hint to load the beginning of the bucket into the cache
     void clear() {
         if(m_data != nullptr) {
-            free(m_data);
+            allocator_type::deallocate(m_data);
         }
         m_data = nullptr;
         ON_DEBUG(m_size = 0;)
@@ -411,16 +626,16 @@ class varwidth_bucket {
 
     varwidth_bucket() = default;
 
-    void initialize(const size_t length, const uint_fast8_t width) {
+    void initialize(const size_t length, const uint_fast8_t width, allocator_type& allocator = allocator_type::instance()) {
        DDCHECK(m_data == nullptr);
-        m_data = reinterpret_cast<internal_type*>  (malloc(sizeof(internal_type)* ceil_div<size_t>(length*width, storage_bitwidth) ));
+        m_data = reinterpret_cast<internal_type*>  (allocator.allocate(sizeof(internal_type)* ceil_div<size_t>(length*width, storage_bitwidth), alignof(internal_type)));
         ON_DEBUG(m_size = ceil_div<size_t>(length*width, storage_bitwidth);)
         ON_DEBUG(m_length = length;)
     }
 
-    void resize(const size_t oldsize, const size_t length, const size_t width) {
+    void resize(const size_t oldsize, const size_t length, const size_t width, allocator_type& allocator = allocator_type::instance()) {
        if(ceil_div<size_t>((oldsize)*width, storage_bitwidth) < ceil_div<size_t>((length)*width, storage_bitwidth)) {
-          m_data = reinterpret_cast<internal_type*>  (realloc(m_data, sizeof(internal_type) * ceil_div<size_t>(length*width, storage_bitwidth ) ));
+          m_data = reinterpret_cast<internal_type*>  (allocator.reallocate(m_data, sizeof(internal_type) * ceil_div<size_t>(oldsize*width, storage_bitwidth), sizeof(internal_type) * ceil_div<size_t>(length*width, storage_bitwidth ), alignof(internal_type)));
        }
        ON_DEBUG(m_size = ceil_div<size_t>(length*width, storage_bitwidth);)
        ON_DEBUG(m_length = length;)
@@ -431,23 +646,8 @@ class varwidth_bucket {
        DDCHECK_LE(length, m_length);
        DDCHECK_LT(position, m_length);
 
-	   //! moves elements in 64-bit blocks
-	   const uint64_t* read_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(position+1)*width)/storage_bitwidth);
-	   uint8_t read_offset = ((position+1)* width) % storage_bitwidth;
-	   uint64_t* write_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(position)*width)/storage_bitwidth);
-	   uint8_t write_offset = ((position)* width) % storage_bitwidth;
-
-	   for(size_t i = 0; i < ( (length-position)*width) / 64; ++i) {
-		   const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, 64);
-		   tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, read_chunk, write_offset, 64);
-	   }
-
-	   //! the final block could be smaller than 64-bits
-	   const size_t remaining_bits = ((length-position)*width) - (( (length-position)*width) / 64)*64;
-	   if(remaining_bits > 0) {
-		   const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, remaining_bits);
-		   tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, read_chunk, write_offset, remaining_bits);
-	   }
+	   //! shifts the elements after `position` by one element to the front
+	   move_bits(m_data, static_cast<uint64_t>(position)*width, static_cast<uint64_t>(position+1)*width, static_cast<uint64_t>(length-position-1)*width);
 	}
 
     void write(const size_t i, const storage_type key, const uint_fast8_t width) {
@@ -468,6 +668,11 @@ class varwidth_bucket {
     size_t find(const storage_type& key, const size_t length, const uint_fast8_t width) const {
        DDCHECK_LE(length, m_length);
        DDCHECK_LE(length*width, m_size*storage_bitwidth);
+#ifdef SEPARATE_X86_TARGETS
+       if(width <= simd::packed_avx2_max_width && simd::best_isa() >= simd::isa::avx2) {
+          return simd::find_packed_avx2(reinterpret_cast<const uint8_t*>(m_data), length, width, key);
+       }
+#endif
        if(length > BROADWORD_SEARCH_THRESHOLD && width < 64) {
           return broadwordsearch::broadsearch(reinterpret_cast<uint64_t*>(m_data), length, width, key);
        }
@@ -595,7 +800,36 @@ class varwidth_bucket {
 //     }
 // };
 
+/**
+ * Erase policies remove the element at `position` from a bucket storing `length` elements.
+ * `ordered_erase` shifts all subsequent elements one position to the front, keeping the order of insertion.
+ * `unordered_erase` moves the last element into the hole, which costs a single read and write regardless of `length`.
+ * `moved_from` returns the old position of the element now stored at `position` after `erase`, or -1 if none moved there.
+ */
+struct ordered_erase {
+    static constexpr bool preserves_order = true;
 
+    template<class bucket_type>
+    static void erase(bucket_type& bucket, const size_t position, const size_t length, const uint_fast8_t width) {
+        bucket.erase(position, length, width);
+    }
+    static constexpr size_t moved_from(const size_t position, const size_t length) {
+        return position+1 < length ? position+1 : -1ULL;
+    }
+};
 
-}//ns separate_chaining
+struct unordered_erase {
+    static constexpr bool preserves_order = false;
+
+    template<class bucket_type>
+    static void erase(bucket_type& bucket, const size_t position, const size_t length, const uint_fast8_t width) {
+        if(position+1 < length) {
+            bucket.write(position, bucket.read(length-1, width), width);
+        }
+    }
+    static constexpr size_t moved_from(const size_t position, const size_t length) {
+        return position+1 < length ? length-1 : -1ULL;
+    }
+};
 
+}//ns separate_chaining
@@ -6,6 +6,7 @@
 #include "dcheck.hpp"
 #include "bucket.hpp"
 #include "size.hpp"
+#include "stats.hpp"
 
 #if STATS_ENABLED
 #include <tudocomp_stat/StatPhase.hpp>
@@ -277,6 +278,23 @@ class bucket_table {
     }
 #endif
 
+    //! reports the memory consumption of the single bucket, @see table_stats
+    table_stats stats() const {
+        table_stats stats;
+        stats.elements = m_elements;
+        stats.key_width = m_width;
+        stats.value_width = sizeof(value_type)*8;
+        stats.quotient_width = m_width; // the keys are stored without hashing
+        stats.add_bucket(m_elements);
+        stats.metadata_bytes = sizeof(class_type);
+        if(m_keys.initialized()) {
+            stats.capacity = capacity();
+            stats.key_bytes = key_bucket_type::size_in_bytes(stats.capacity, m_width);
+            stats.value_bytes = value_bucket_type::size_in_bytes(stats.capacity, stats.value_width);
+        }
+        return stats;
+    }
+
     const iterator end() {
         return iterator { *this, static_cast<size_t>(-1ULL) };
     }
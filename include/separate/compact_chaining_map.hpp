@@ -1,6 +1,7 @@
 #pragma once
 
 #include "separate_chaining_table.hpp"
+#include "bitmove.hpp"
 #include <type_traits>
 
 
@@ -67,8 +68,9 @@ namespace separate_chaining {
 
 /**
  * hash_mapping_t: a hash mapping from `hash.hpp`
+ * erase_policy_t: either `ordered_erase` or `unordered_erase` from `bucket.hpp`
  */
-template<class hash_mapping_t, class storage_t = uint8_t>
+template<class hash_mapping_t, class storage_t = uint8_t, class erase_policy_t = ordered_erase>
 class compact_chaining_map {
     public:
     using hash_mapping_type = hash_mapping_t;
@@ -84,7 +86,8 @@ class compact_chaining_map {
 
     using bucketsize_type = separate_chaining::bucketsize_type; //! used for storing the sizes of the buckets
     using size_type = uint64_t; //! used for addressing the i-th bucket
-    using class_type = compact_chaining_map<hash_mapping_type, storage_type>;
+    using erase_policy_type = erase_policy_t; //! how an element is removed from its bucket
+    using class_type = compact_chaining_map<hash_mapping_type, storage_type, erase_policy_type>;
     using iterator = separate_chaining_iterator<class_type>;
     using const_iterator = separate_chaining_iterator<const class_type>;
     using navigator = separate_chaining_navigator<class_type>;
@@ -292,6 +295,30 @@ class compact_chaining_map {
     }
 #endif
 
+    //! reports the distribution of the bucket sizes and the memory consumption, @see table_stats
+    table_stats stats() const {
+        table_stats stats;
+        stats.elements = m_elements;
+        stats.key_width = key_width();
+        stats.value_width = value_width();
+        stats.quotient_width = m_hash.remainder_width(m_buckets);
+        stats.capacity = capacity();
+        stats.metadata_bytes = sizeof(class_type) + bucket_count() * (sizeof(storage_type*) + sizeof(bucketsize_type));
+        const size_t cbucket_count = bucket_count();
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            const size_t size = m_bucketsizes[bucket];
+            stats.add_bucket(size);
+            if(size == 0) continue;
+            // quotients and values share the same array; its padding is counted as metadata
+            const size_t key_bytes = ceil_div<size_t>(size*stats.quotient_width, 8);
+            const size_t value_bytes = ceil_div<size_t>(size*stats.value_width, 8);
+            stats.key_bytes += key_bytes;
+            stats.value_bytes += value_bytes;
+            stats.metadata_bytes += sizeof(storage_type) * ceil_div<size_t>(size*(stats.quotient_width+stats.value_width), storage_bitwidth) - key_bytes - value_bytes;
+        }
+        return stats;
+    }
+
 
     //! Allocate `reserve` buckets. Do not confuse with reserving space for `reserve` elements.
     void reserve(size_t reserve) {
@@ -430,6 +457,11 @@ class compact_chaining_map {
         DDCHECK_EQ(ret, m_large_storage[bucket][position]);
         return ret;
     }
+    //! returns the key stored at position `position` of bucket `bucket`
+    key_type key_at(const size_t bucket, const size_t position) const {
+        const uint_fast8_t quotient_bitwidth = m_hash.remainder_width(m_buckets);
+        return m_hash.inv_map(quotient_at(bucket, position, quotient_bitwidth), bucket, m_buckets);
+    }
     public:
     // const value_type& value_at(const size_t bucket, const size_t position) const {
     //     return const_cast<class_type&>(*this).value_at(bucket, position);
@@ -448,7 +480,7 @@ class compact_chaining_map {
         return ret;
     }
 
-    void write_quotient(const size_t bucket, const size_t position, const uint_fast8_t quotient_width, const key_type quotient) const {
+    void write_quotient(const size_t bucket, const size_t position, const uint_fast8_t quotient_width, const key_type quotient) {
         ON_DEBUG(m_large_storage[bucket][position] = quotient;)
         DDCHECK_EQ(m_large_storage[bucket][position], quotient);
         DDCHECK_LT((static_cast<size_t>(position)*quotient_width)/storage_bitwidth + ((position)* quotient_width) % storage_bitwidth, storage_bitwidth*ceil_div<size_t>(m_bucketsizes[bucket]*quotient_width, storage_bitwidth) );
@@ -462,7 +494,7 @@ class compact_chaining_map {
     }
 
 
-    void write_value(const size_t bucket, const size_t position, const value_type value) const {
+    void write_value(const size_t bucket, const size_t position, const value_type value) {
         ON_DEBUG(m_large_storage[bucket][m_bucketsizes[bucket]+position] = value;)
 
         const uint_fast8_t quotient_bitwidth = m_hash.remainder_width(m_buckets);
@@ -500,15 +532,9 @@ class compact_chaining_map {
             large_storage[i] = large_storage[i-1];
         })
         
-        storage_type*& small_storage = m_storage[bucket];
-        for(size_t i = 1; i <= old_bucket_size; ++i) {
-            const size_t from_bit_position = old_bucket_size*quotient_bitwidth + (old_bucket_size - i)*value_width();
-            const size_t to_bit_position = bucket_size*quotient_bitwidth + (old_bucket_size - i)*value_width();
-            const uint64_t read_value = read_compact_int(small_storage, from_bit_position, value_width());
-
-            DDCHECK_LE(to_bit_position+value_width(), m_storagesizes[bucket]);
-            write_compact_int(small_storage, to_bit_position, value_width(), read_value);
-        }
+        // make room for a quotient by shifting all values by one quotient to the back
+        DDCHECK_LE(bucket_size*quotient_bitwidth + old_bucket_size*value_width(), m_storagesizes[bucket]);
+        move_bits(m_storage[bucket], bucket_size*quotient_bitwidth, old_bucket_size*quotient_bitwidth, old_bucket_size*value_width());
 
         ON_DEBUG(
         for(size_t i = 0; i < old_bucket_size; ++i) {
@@ -627,7 +653,15 @@ class compact_chaining_map {
     }
 
     size_type erase(const size_t bucket, const size_t position) {
+        size_t moved_from;
+        return erase(bucket, position, moved_from);
+    }
+
+    //! removes the element at `position` of `bucket`, @see separate_chaining_table::erase(bucket, position, moved_from)
+    size_type erase(const size_t bucket, size_t position, size_t& moved_from) {
+        moved_from = -1ULL;
         if(position == static_cast<size_t>(-1ULL)) return 0;
+        moved_from = erase_policy_type::moved_from(position, m_bucketsizes[bucket]);
 
 
         bucketsize_type& bucket_size = m_bucketsizes[bucket];
@@ -647,15 +681,27 @@ class compact_chaining_map {
         }
 #endif
 
+        if constexpr(!erase_policy_type::preserves_order) {
+            // move the last element into the gap, and erase the last position, which needs no shifting of quotients
+            const size_t last = bucket_size-1;
+            if(position != last) {
+                write_quotient(bucket, position, quotient_bitwidth, quotient_at(bucket, last, quotient_bitwidth));
+                write_value(bucket, position, value_at(bucket, last));
+                ON_DEBUG(bucket_plainkeys[position] = bucket_plainkeys[last];)
+                position = last;
+            }
+        }
+
         ON_DEBUG(
         for(size_t i = position+1; i < bucket_size; ++i) {
             bucket_plainkeys[i-1] = bucket_plainkeys[i];
             bucket_plainvalues[i-1] = bucket_plainvalues[i];
+            m_large_storage[bucket][i-1] = m_large_storage[bucket][i];
         })
 
-        for(size_t i = position+1; i < bucket_size; ++i) {
-            write_quotient(bucket, i-1, quotient_bitwidth, quotient_at(bucket, i, quotient_bitwidth));
-        }
+        storage_type*& small_storage = m_storage[bucket];
+        // shift the quotients after `position` by one quotient to the front
+        move_bits(small_storage, position*quotient_bitwidth, (position+1)*quotient_bitwidth, (bucket_size-position-1)*quotient_bitwidth);
         // for(size_t i = 1; i < position; ++i) {
         //     write_value_(bucket, i-1, value_at_(bucket, i));
         // }
@@ -672,23 +718,12 @@ class compact_chaining_map {
             large_storage[i-2] = large_storage[i];
         })
 
-        storage_type*& small_storage = m_storage[bucket];
-        for(size_t i = 0; i < position; ++i) {
-            const size_t from_bit_position = (bucket_size)*quotient_bitwidth + (i)*value_width();
-            const size_t to_bit_position = (bucket_size-1)*quotient_bitwidth + (i)*value_width();
-            const uint64_t read_value = read_compact_int(small_storage, from_bit_position, value_width());
-
-            DDCHECK_LE(to_bit_position+value_width(), m_storagesizes[bucket]);
-            write_compact_int(small_storage, to_bit_position, value_width(), read_value);
-        }
-        for(size_t i = position+1; i < bucket_size; ++i) {
-            const size_t from_bit_position = (bucket_size)*quotient_bitwidth + (i)*value_width();
-            const size_t to_bit_position = (bucket_size-1)*quotient_bitwidth + (i-1)*value_width();
-            const uint64_t read_value = read_compact_int(small_storage, from_bit_position, value_width());
-
-            DDCHECK_LE(to_bit_position+value_width(), m_storagesizes[bucket]);
-            write_compact_int(small_storage, to_bit_position, value_width(), read_value);
-        }
+        // the values start one quotient earlier; the value at `position` is dropped
+        const size_t values_from = (bucket_size)*quotient_bitwidth;
+        const size_t values_to = (bucket_size-1)*quotient_bitwidth;
+        DDCHECK_LE(values_to + (bucket_size-1)*value_width(), m_storagesizes[bucket]);
+        move_bits(small_storage, values_to, values_from, position*value_width());
+        move_bits(small_storage, values_to + position*value_width(), values_from + (position+1)*value_width(), (bucket_size-position-1)*value_width());
 
 
         DDCHECK_GT(bucket_size, 0);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include "mapped_chaining_table.hpp"
+
+namespace separate_chaining {
+
+//! a single allocation of 64-bit words holding the layout of a frozen table
+class frozen_storage {
+    protected:
+    uint64_t* m_buffer = nullptr;
+    size_t m_length = 0; //! length of the layout in bytes
+
+    //! writes to the buffer like an `std::ostream`
+    class buffer_writer {
+        char* m_position;
+        public:
+        buffer_writer(char* buffer) : m_position(buffer) {}
+        void write(const char* data, const size_t length) {
+            std::memcpy(m_position, data, length);
+            m_position += length;
+        }
+        const char* position() const { return m_position; }
+    };
+
+    template<class table_type>
+    frozen_storage(const table_type& table)
+        : m_length(mapped_layout(table).m_file_size) {
+        m_buffer = reinterpret_cast<uint64_t*>(malloc(ceil_div<size_t>(m_length, sizeof(uint64_t)) * sizeof(uint64_t)));
+        if(m_buffer == nullptr) { throw std::bad_alloc(); }
+        buffer_writer writer(reinterpret_cast<char*>(m_buffer));
+        write_mapped(table, writer);
+        DDCHECK_EQ(static_cast<size_t>(writer.position() - reinterpret_cast<const char*>(m_buffer)), m_length);
+    }
+    frozen_storage(frozen_storage&& other) : m_buffer(other.m_buffer), m_length(other.m_length) {
+        other.m_buffer = nullptr;
+    }
+    frozen_storage(const frozen_storage&) = delete;
+    frozen_storage& operator=(const frozen_storage&) = delete;
+    ~frozen_storage() { free(m_buffer); }
+};
+
+/**
+ * Immutable copy of a `separate_chaining_table` with integer keys and values, stored in a single allocation.
+ * Instead of a key and a value bucket per bucket, all quotients and all values are bit-packed in one array each,
+ * and the start of a bucket is found by an offset index sampling every `MAPPED_SAMPLE_RATE`-th bucket.
+ * This saves the pointers of the buckets and the overhead of their allocations, and keeps neighboring buckets in neighboring cache lines.
+ * The table uses the layout of `write_mapped`, and offers the same query and iteration interface as `mapped_chaining_table`.
+ *
+ * table_type: the type of the `separate_chaining_table` that is frozen
+ */
+template<class table_type>
+class frozen_chaining_table : private frozen_storage, public mapped_chaining_table<table_type> {
+    using super_type = mapped_chaining_table<table_type>;
+
+    public:
+    using class_type = frozen_chaining_table<table_type>;
+    using size_type = typename super_type::size_type;
+
+    //! copies `table` into the frozen layout; `table` can be cleared afterwards
+    frozen_chaining_table(const table_type& table)
+        : frozen_storage(table)
+        , super_type(reinterpret_cast<const char*>(m_buffer), m_length) {}
+
+    frozen_chaining_table(frozen_chaining_table&& other)
+        : frozen_storage(std::move(other))
+        , super_type(std::move(other)) {}
+
+    //! number of bytes the hash table uses
+    size_type size_in_bytes() const {
+        return sizeof(class_type) + m_length;
+    }
+
+    //! writes the layout to `os`, which can be memory-mapped by a `mapped_chaining_table`
+    void serialize(std::ostream& os) const {
+        os.write(reinterpret_cast<const char*>(m_buffer), m_length);
+    }
+};
+
+//! returns an immutable copy of `table` stored in a single allocation, @see frozen_chaining_table
+template<class table_type>
+frozen_chaining_table<table_type> freeze(const table_type& table) {
+    return frozen_chaining_table<table_type>(table);
+}
+
+}//ns separate_chaining
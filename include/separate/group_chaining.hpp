@@ -2,10 +2,13 @@
 #include <tudocomp/util/sdsl_bits.hpp>
 #include "dcheck.hpp"
 #include "bucket.hpp"
+#include "bitmove.hpp"
 #include "select.hpp"
 #include "hash.hpp"
 #include "overflow.hpp"
 #include "iterator.hpp"
+#include "stats.hpp"
+#include "instrumentation.hpp"
 
 namespace separate_chaining {
 
@@ -107,27 +110,9 @@ class core_group {
       DDCHECK_EQ(length, m_length);
 
 
-	  {//! moves elements in 64-bit blocks
-		  const uint64_t* read_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(index+1)*key_width)/storage_bitwidth);
-		  uint8_t read_offset = ((index+1)* key_width) % storage_bitwidth;
-		  uint64_t* write_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(index)*key_width)/storage_bitwidth);
-		  uint8_t write_offset = ((index)* key_width) % storage_bitwidth;
+	  //! shifts the elements after `index` by one element to the front
+	  move_bits(m_data, static_cast<uint64_t>(index)*key_width, static_cast<uint64_t>(index+1)*key_width, static_cast<uint64_t>(length-index-1)*key_width);
 
-		  for(size_t i = 0; i < ( (length-index)*key_width) / 64; ++i) {
-			  const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, 64);
-			  tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, read_chunk, write_offset, 64);
-		  }
-
-		  //! the final block could be smaller than 64-bits
-		  const size_t remaining_bits = ((length-index)*key_width) - (( (length-index)*key_width) / 64)*64;
-		  if(remaining_bits > 0) {
-			  const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int_and_move(read_it, read_offset, remaining_bits);
-			  tdc::tdc_sdsl::bits_impl<>::write_int_and_move(write_it, read_chunk, write_offset, remaining_bits);
-		  }
-	  }
-
-
- 
 #if(0) // move element by element
        for(size_t i = index; i+1 < length; ++i) { 
            const size_t oldkey = read_(i+1, key_width);
@@ -193,51 +178,9 @@ class core_group {
        }
 #endif//0
 
-	   {//!insertion into m_data by word_packing
-		   uint64_t read_pos = static_cast<size_t>(length)*key_width;
-		   if(((length-index)*key_width)/64 > 0) { //! first copy in 64-bit blocks to the right
-			   const uint64_t read_position = read_pos-64;
-			   DDCHECK_LE(read_position+64, m_length*key_width);
-			   const uint64_t* read_it = reinterpret_cast<uint64_t*>(m_data + read_position/storage_bitwidth);
-			   uint8_t read_offset = read_position % storage_bitwidth;
-
-			   const uint64_t write_position = read_pos+key_width-64;
-			   DDCHECK_LE(write_position+64, m_length*key_width);
-			   uint64_t* write_it = reinterpret_cast<uint64_t*>(m_data + write_position / storage_bitwidth);
-			   uint8_t write_offset = write_position % storage_bitwidth;
-
-			   //! start with the largest block, and move its elements one to the right
-			   for(size_t i = 0; i < ( (length-index)*key_width) / 64; ++i) {
-				   const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int(read_it, read_offset, 64);
-				   DDCHECK_LE((reinterpret_cast<size_t>(write_it) - reinterpret_cast<size_t>(m_data))*8 + write_offset + 64, 8*sizeof(internal_type)* m_blocksize);
-				   tdc::tdc_sdsl::bits_impl<>::write_int(write_it, read_chunk, write_offset, 64);
-				   tdc::tdc_sdsl::bits_impl<>::move_left(read_it, read_offset, 64);
-				   tdc::tdc_sdsl::bits_impl<>::move_left((const uint64_t*&)write_it, write_offset, 64);
-				   DDCHECK_GE(read_pos, 64);
-				   read_pos -= 64;
-			   }
-		   }
-
-		   //! the place where entry 'index' is located
-		   uint64_t*const read_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(index)*key_width)/storage_bitwidth);
-		   const uint8_t read_offset = ((index)* key_width) % storage_bitwidth;
-
-		   if(length > 0 && read_pos > index*key_width) { //! have we already copied the entry of 'index'?
-
-			   uint64_t*const write_it = reinterpret_cast<uint64_t*>(m_data + (static_cast<size_t>(index+1)*key_width)/storage_bitwidth);
-			   const uint8_t write_offset = ((index+1)* key_width) % storage_bitwidth;
-
-			   //! the number of bits needed to be copied
-			   const size_t remaining_bits = ((length-index)*key_width) - (((length-index)*key_width) / 64)*64;
-			   DCHECK_GE(remaining_bits, 0);
-
-			   const size_t read_chunk = tdc::tdc_sdsl::bits_impl<>::read_int(read_it, read_offset, remaining_bits);
-			   DDCHECK_LE((reinterpret_cast<size_t>(write_it) - reinterpret_cast<size_t>(m_data))*8 + write_offset+ remaining_bits, 8*sizeof(internal_type)* m_blocksize);
-			   tdc::tdc_sdsl::bits_impl<>::write_int(write_it, read_chunk, write_offset, remaining_bits);
-		   }
-		   DDCHECK_LE((reinterpret_cast<size_t>(read_it) - reinterpret_cast<size_t>(m_data))*8 + read_offset + key_width, 8*sizeof(internal_type)* m_blocksize);
-		   tdc::tdc_sdsl::bits_impl<>::write_int(read_it, key, read_offset, key_width);
-	   }
+	   //! shifts the elements from `index` on by one element to the back, and writes `key` into the gap
+	   move_bits(m_data, static_cast<uint64_t>(index+1)*key_width, static_cast<uint64_t>(index)*key_width, static_cast<uint64_t>(length-index)*key_width);
+	   write_bits(reinterpret_cast<uint8_t*>(m_data), static_cast<uint64_t>(index)*key_width, key_width, key);
 #ifndef NDEBUG
        for(size_t i = 0; i < length; ++i) {
            DDCHECK_EQ(m_plain_data[i], read(i, key_width));
@@ -644,7 +587,7 @@ class keyvalue_group {
       const size_t group_begin = groupindex == 0 ? 0 : find_group_position(groupindex-1)+1;
       return  m_values.read(group_begin+position-groupindex, valuewidth);
     }
-    void write_value(size_t groupindex, size_t position, size_t value, uint_fast8_t valuewidth) const {
+    void write_value(size_t groupindex, size_t position, size_t value, uint_fast8_t valuewidth) {
       DDCHECK_LT(groupindex, m_groupsize);
       const size_t group_begin = groupindex == 0 ? 0 : find_group_position(groupindex-1)+1;
       m_values.write(group_begin+position-groupindex, value, valuewidth);
@@ -706,8 +649,11 @@ class keyvalue_group {
  * key_bucket_t: a bucket from `bucket.hpp`
  * hash_mapping_t: a hash mapping from `hash.hpp`
  * resize_strategy_t: either `arbitrary_resize` or `incremental_resize`
+ * instrumentation_t: either `no_instrumentation` or `counting_instrumentation` from `instrumentation.hpp`, @see counters()
+ *
+ * Thread safety: as for `separate_chaining_table`, const member functions can be called concurrently on a table that is not modified meanwhile.
  */
-template<class hash_mapping_t = xorshift_hash<>, class overflow_t = dummy_overflow<uint64_t,uint64_t>> //TODO: make overflow types bit-aware!
+template<class hash_mapping_t = xorshift_hash<>, class overflow_t = dummy_overflow<uint64_t,uint64_t>, class instrumentation_t = no_instrumentation> //TODO: make overflow types bit-aware!
 class group_chaining_table {
     public:
     using key_type = uint64_t;
@@ -722,7 +668,8 @@ class group_chaining_table {
     using hash_mapping_type = hash_mapping_t;
     static_assert(std::is_same<typename hash_mapping_t::storage_type, storage_type>::value, "hash_mapping_t::storage_type must be uint64_t!");
 
-    using class_type = group_chaining_table<hash_mapping_type, overflow_type>;
+    using instrumentation_type = instrumentation_t; //! counts the operations on the hot paths, or does nothing by default
+    using class_type = group_chaining_table<hash_mapping_type, overflow_type, instrumentation_type>;
     using iterator = separate_chaining_iterator<class_type>;
     using const_iterator = separate_chaining_iterator<const class_type>;
     using navigator = separate_chaining_navigator<class_type>;
@@ -736,8 +683,9 @@ class group_chaining_table {
     uint_fast8_t m_key_width;
     uint_fast8_t m_value_width;
     hash_mapping_type m_hash; //! hash function
-    mutable overflow_type m_overflow; //TODO: cht_overflow has non-const operations
+    overflow_type m_overflow;
     uint_fast8_t m_buckets_per_group;
+    instrumentation_type m_instrumentation;
 
     ON_DEBUG(key_type** m_plainkeys = nullptr;) //!bucket for keys in plain format for debugging purposes
     ON_DEBUG(value_type** m_plainvalues = nullptr;) //!bucket for values in plain format for debugging purposes
@@ -764,6 +712,7 @@ class group_chaining_table {
         std::swap(m_hash, other.m_hash);
         std::swap(m_elements, other.m_elements);
         std::swap(m_overflow, other.m_overflow);
+        std::swap(m_instrumentation, other.m_instrumentation);
     }
 
 
@@ -864,6 +813,11 @@ class group_chaining_table {
         DCHECK_LT(bucket, bucket_count());
         return m_groups[bucketgroup(bucket)].read_key(rank_in_group(bucket), position, key_bitwidth);
     }
+    //! returns the key stored at position `position` of bucket `bucket`
+    key_type key_at(const size_t bucket, const size_t position) const {
+        const uint_fast8_t key_bitwidth = m_hash.remainder_width(m_buckets);
+        return m_hash.inv_map(quotient_at(bucket, position, key_bitwidth), bucket, m_buckets);
+    }
     // const value_type value_at(const size_t bucket, const size_t position, uint_fast8_t value_bitwidth) const {
     //     return m_groups[bucketgroup(bucket)].read_value(rank_in_group(bucket), position, value_bitwidth);
     // }
@@ -874,7 +828,7 @@ class group_chaining_table {
         DCHECK_LT(bucket, bucket_count());
         return m_groups[bucketgroup(bucket)].read_value(rank_in_group(bucket), position, value_width());
     }
-    void write_value(const size_t bucket, const size_t position, const size_t value) const {
+    void write_value(const size_t bucket, const size_t position, const size_t value) {
         if(bucket == bucket_count()) {
             m_overflow[position] = value;
         }
@@ -975,6 +929,7 @@ class group_chaining_table {
             m_buckets = reserve_bits;
             m_overflow.resize_buckets(new_size, key_width(), value_width());
         } else {
+            const typename instrumentation_type::rehash_timer timer(m_instrumentation);
             group_chaining_table tmp_map(new_key_width, m_value_width);
 			tmp_map.m_buckets_per_group = 64; //std::min<size_t>(255, std::max<size_t>(3, size() / (1+bucket_count())));
 			//tmp_map.m_buckets_per_group = std::min<size_t>(255, std::max<size_t>(32, size() / group_count()));
@@ -1029,6 +984,7 @@ class group_chaining_table {
                 }
             }
             DDCHECK_EQ(m_elements, tmp_map.m_elements);
+            tmp_map.m_instrumentation = m_instrumentation;
             clear_structure();
             swap(tmp_map);
         }
@@ -1067,7 +1023,9 @@ class group_chaining_table {
     const iterator end() {
         return { *this, -1ULL, -1ULL };
     }
-    const iterator begin() {
+    private:
+    //! returns the bucket of the first element, which is `bucket_count()` if only the overflow table stores elements, or -1 if the table is empty
+    size_t first_bucket() const {
 
         // const size_t cbucket_count = bucket_count();
         // for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
@@ -1085,15 +1043,30 @@ class group_chaining_table {
 				for(size_t bucket_it = 0; bucket_it < buckets_per_group(); ++bucket_it) { 
 					const size_t elements = group.bucketsize(rank_in_group(bucket_it));
 					if(elements > 0) {
-						return { *this, (group_it) * buckets_per_group() + (bucket_it), 0 };
+						return (group_it) * buckets_per_group() + (bucket_it);
 					}
 				}
 			}
 		}
 
-        const size_t cbucket_count = bucket_count();
-        if(m_overflow.size() > 0) return { *this, cbucket_count, 0 };
-        return end();
+        if(m_overflow.size() > 0) return bucket_count();
+        return -1ULL;
+    }
+    public:
+    const iterator begin() {
+        const size_t bucket = first_bucket();
+        if(bucket == static_cast<size_t>(-1ULL)) return end();
+        return { *this, bucket, 0 };
+    }
+    const const_iterator cbegin() const {
+        const size_t bucket = first_bucket();
+        if(bucket == static_cast<size_t>(-1ULL)) return cend();
+        return { *this, bucket, 0 };
+    }
+    const const_navigator cbegin_nav() const {
+        const size_t bucket = first_bucket();
+        if(bucket == static_cast<size_t>(-1ULL)) return cend_nav();
+        return { *this, bucket, 0 };
     }
     const navigator end_nav() {
         return { *this, -1ULL, -1ULL };
@@ -1106,6 +1079,7 @@ class group_chaining_table {
         if(m_buckets == 0) return cend();
         if(m_overflow.size() > 0) {
             const size_t position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(position != static_cast<size_t>(-1ULL));
             if(position != static_cast<size_t>(-1ULL)) {
                 return const_iterator { *this, bucket_count(), position };
             }
@@ -1119,6 +1093,11 @@ class group_chaining_table {
         return const_iterator { *this, bucket, position };
     }
 
+    /** @see std::set **/
+    size_type count(const key_type& key ) const {
+        return find(key) == cend() ? 0 : 1;
+    }
+
     private:
     size_t locate(const size_t& bucket, const storage_type& quotient) const {
         const uint_fast8_t quotient_width = m_hash.remainder_width(m_buckets);
@@ -1131,7 +1110,7 @@ class group_chaining_table {
 
 #ifndef NDEBUG
         const groupsize_type& bucket_size = group.bucketsize(rank_in_group(bucket));
-        key_type*& bucket_plainkeys = m_plainkeys[bucket];
+        const key_type* bucket_plainkeys = m_plainkeys[bucket];
         size_t plain_position = static_cast<size_t>(-1ULL);
         for(size_t i = 0; i < bucket_size; ++i) { 
             const key_type read_quotient = group.read_key(rank_in_group(bucket),i, quotient_width);
@@ -1146,6 +1125,9 @@ class group_chaining_table {
 #endif//NDEBUG
         
         const size_t position = group.empty() ? (-1ULL) : group.find(rank_in_group(bucket), quotient, quotient_width);
+        if constexpr(instrumentation_type::enabled) { // computing the bucket size needs a select query
+            m_instrumentation.locate(position != static_cast<size_t>(-1ULL) ? position+1 : group.empty() ? 0 : group.bucketsize(rank_in_group(bucket)), position != static_cast<size_t>(-1ULL));
+        }
 
 #ifndef NDEBUG
         DDCHECK_EQ(position, plain_position);
@@ -1173,6 +1155,7 @@ class group_chaining_table {
 
 		if(m_overflow.size() > 0 && m_overflow.need_consult(bucket)) { 
             const size_t position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(position != (-1ULL));
             if(position != (-1ULL)) {
                 return { bucket_count(), position };
             }
@@ -1199,6 +1182,7 @@ class group_chaining_table {
         }
         if(m_overflow.need_consult(bucket)) {
             const size_t overflow_position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(overflow_position != static_cast<size_t>(-1ULL));
             if(overflow_position != static_cast<size_t>(-1ULL)) {
                 return { *this, bucket_count(), overflow_position };
             }
@@ -1211,7 +1195,7 @@ class group_chaining_table {
                 if(overflow_position != static_cast<size_t>(-1ULL)) { // could successfully insert element into overflow table
                     ++m_elements;
                     DDCHECK_EQ(m_overflow.find(key), overflow_position);
-                    DDCHECK_EQ(m_overflow[m_overflow.find(key)], value);
+                    DDCHECK_EQ(static_cast<value_type>(m_overflow[m_overflow.find(key)]), value);
                     return { *this, bucket_count(), overflow_position };
                 }
 			} 
@@ -1226,7 +1210,15 @@ class group_chaining_table {
         DDCHECK_GT(quotient_width, 0);
         DDCHECK_LE(quotient_width, key_width());
 
-        if(!group.initialized()) { group.initialize(buckets_per_group(), quotient_width, value_width());}
+        if(!group.initialized()) { 
+            group.initialize(buckets_per_group(), quotient_width, value_width());
+        } else if constexpr(instrumentation_type::enabled) { // push_back reallocates the keys, the values, and the border bit vector of the group
+            constexpr size_t internal_bytes = sizeof(typename keyvalue_group_type::internal_type);
+            constexpr size_t internal_bitwidth = keyvalue_group_type::internal_bitwidth;
+            const size_t size = group.size();
+            m_instrumentation.bucket_resize(internal_bytes * (ceil_div<size_t>(size*quotient_width, internal_bitwidth) 
+                        + ceil_div<size_t>(size*value_width(), internal_bitwidth) + ceil_div<size_t>(size + 1 + buckets_per_group(), internal_bitwidth)));
+        }
 
 #ifndef NDEBUG
 #ifdef HEAVY_DEBUG
@@ -1416,6 +1408,40 @@ class group_chaining_table {
     }
 #endif
 
+    //! reports the distribution of the bucket sizes and the memory consumption, @see table_stats
+    table_stats stats() const {
+        constexpr size_t internal_bytes = sizeof(typename keyvalue_group_type::internal_type);
+        constexpr size_t internal_bitwidth = keyvalue_group_type::internal_bitwidth;
+        table_stats stats;
+        stats.elements = m_elements;
+        stats.key_width = key_width();
+        stats.value_width = value_width();
+        stats.quotient_width = m_hash.remainder_width(m_buckets);
+        stats.overflow_elements = m_overflow.size();
+        stats.overflow_capacity = m_overflow.capacity();
+        stats.metadata_bytes = sizeof(class_type) + m_overflow.size_in_bytes() + group_count() * sizeof(keyvalue_group_type);
+        const size_t cbucket_count = bucket_count();
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            stats.add_bucket(bucket_size(bucket));
+        }
+        const size_t cgroup_count = group_count();
+        for(size_t group = 0; group < cgroup_count; ++group) {
+            const size_t size = m_groups[group].size();
+            if(size == 0) continue;
+            stats.capacity += size; // groups are always full
+            stats.key_bytes += internal_bytes * ceil_div<size_t>(size*stats.quotient_width, internal_bitwidth);
+            stats.value_bytes += internal_bytes * ceil_div<size_t>(size*stats.value_width, internal_bitwidth);
+            stats.metadata_bytes += internal_bytes * ceil_div<size_t>(size + 1 + buckets_per_group(), internal_bitwidth); // bit vector marking the borders
+        }
+        return stats;
+    }
+
+    //! counters of the hot paths, which are all zero unless `instrumentation_t` is `counting_instrumentation`
+    probe_counters counters() const { return m_instrumentation.counters(); }
+
+    //! sets all counters of `counters()` to zero
+    void reset_counters() { m_instrumentation.reset(); }
+
     //TODO: add swap, operator= and copy-constructor
     void serialize(std::ostream& os) const {
         m_overflow.serialize(os);
@@ -39,6 +39,14 @@ class hash_mapping_adapter {
     key_type inv_map(const storage_type& remainder, [[maybe_unused]] const size_t& hash_value, [[maybe_unused]] const uint8_t table_buckets) const {
         return remainder;
     }
+    //! maps a key stored with `remainder` in bucket `hash_value` of a table with 2^`table_buckets` buckets to the table with twice as many buckets
+    std::pair<storage_type, size_t> split(const storage_type& remainder, [[maybe_unused]] const size_t& hash_value, const uint8_t table_buckets) const {
+        return map(remainder, table_buckets+1);
+    }
+    //! maps a key stored with `remainder` in bucket `hash_value` of a table with 2^`table_buckets` buckets to the table with half as many buckets
+    std::pair<storage_type, size_t> merge(const storage_type& remainder, const size_t& hash_value, const uint8_t table_buckets) const {
+        return std::make_pair(remainder, hash_value & ((1ULL << (table_buckets-1)) - 1ULL));
+    }
 };
 
 template<class key_t = uint64_t, class storage_t = key_t, class bijective_function = bijective_hash::Xorshift>
@@ -70,6 +78,25 @@ class bijective_hash_adapter {
     key_type inv_map(const storage_type remainder, const size_t hash_value, const uint8_t table_buckets) const {
         return func.hash_inv( (static_cast<uint64_t>(remainder) << table_buckets) + hash_value);
     }
+    /**
+     * maps a key stored with `remainder` in bucket `hash_value` of a table with 2^`table_buckets` buckets to the table with twice as many buckets.
+     * The lowest bit of the remainder becomes the highest bit of the bucket, such that no hashing is involved.
+     */
+    std::pair<storage_type, size_t> split(const storage_type remainder, const size_t hash_value, const uint8_t table_buckets) const {
+        const auto ret = std::make_pair(static_cast<storage_type>(remainder >> 1), hash_value | (static_cast<size_t>(remainder & 1ULL) << table_buckets));
+        DDCHECK_EQ(inv_map(ret.first, ret.second, table_buckets+1), inv_map(remainder, hash_value, table_buckets));
+        return ret;
+    }
+    /**
+     * maps a key stored with `remainder` in bucket `hash_value` of a table with 2^`table_buckets` buckets to the table with half as many buckets,
+     * inverting `split`: the highest bit of the bucket becomes the lowest bit of the remainder.
+     */
+    std::pair<storage_type, size_t> merge(const storage_type remainder, const size_t hash_value, const uint8_t table_buckets) const {
+        DDCHECK_GT(table_buckets, 1);
+        const auto ret = std::make_pair(static_cast<storage_type>((static_cast<uint64_t>(remainder) << 1) | (hash_value >> (table_buckets-1))), hash_value & ((1ULL << (table_buckets-1)) - 1ULL));
+        DDCHECK_EQ(inv_map(ret.first, ret.second, table_buckets-1), inv_map(remainder, hash_value, table_buckets));
+        return ret;
+    }
 };
 
 template<class key_t = uint64_t, class storage_t = key_t> using xorshift_hash = bijective_hash_adapter<key_t, storage_t, bijective_hash::Xorshift>;
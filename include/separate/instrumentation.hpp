@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace separate_chaining {
+
+//! counters of the hot paths of a hash table, reported by `counters()` of a table instrumented with `counting_instrumentation`
+struct probe_counters {
+    size_t locates = 0; //! number of bucket scans
+    size_t comparisons = 0; //! number of quotients compared by the bucket scans, i.e., the position of the found quotient plus one, or the bucket size on a miss
+    size_t hits = 0; //! bucket scans that found their quotient
+    size_t misses = 0; //! bucket scans that did not find their quotient
+    size_t overflow_consults = 0; //! lookups in the overflow table
+    size_t overflow_hits = 0; //! lookups in the overflow table that found their key
+    size_t bucket_resizes = 0; //! reallocations of a bucket (or a group in `group_chaining_table`)
+    size_t bytes_moved = 0; //! bytes of the reallocated buckets before the reallocation, an upper bound on what `realloc` copies
+    size_t rehashes = 0; //! rehashes by `reserve` on a table that already has buckets, including those triggered by an insertion
+    double rehash_seconds = 0; //! wall time spent in these rehashes; for an incremental rehash, only its start is measured
+};
+
+/**
+ * Default instrumentation policy of the hash tables: all hooks are empty and get optimized away.
+ * An instrumentation policy is the last template parameter of `separate_chaining_table` and `group_chaining_table`,
+ * which call its hooks on their hot paths.
+ */
+struct no_instrumentation {
+    static constexpr bool enabled = false;
+
+    constexpr void locate([[maybe_unused]] const size_t comparisons, [[maybe_unused]] const bool found) const {}
+    constexpr void overflow_consult([[maybe_unused]] const bool found) const {}
+    constexpr void bucket_resize([[maybe_unused]] const size_t bytes) {}
+
+    //! measures the time of a rehash from its construction to its destruction
+    struct rehash_timer {
+        constexpr rehash_timer(no_instrumentation&) {}
+    };
+
+    probe_counters counters() const { return {}; }
+    void reset() {}
+};
+
+/**
+ * Counts the calls of the hooks in a `probe_counters`.
+ * Since lookups are const member functions that may run concurrently, the counters of lookups are mutable relaxed atomics.
+ * The counters of bucket reallocations are relaxed atomics, too, since `striped_chaining_map` reallocates buckets of different stripes concurrently.
+ * The counters of rehashes are plain, since a rehash requires exclusive access to the table.
+ */
+class counting_instrumentation {
+    mutable std::atomic<size_t> m_locates {0};
+    mutable std::atomic<size_t> m_comparisons {0};
+    mutable std::atomic<size_t> m_hits {0};
+    mutable std::atomic<size_t> m_misses {0};
+    mutable std::atomic<size_t> m_overflow_consults {0};
+    mutable std::atomic<size_t> m_overflow_hits {0};
+    std::atomic<size_t> m_bucket_resizes {0};
+    std::atomic<size_t> m_bytes_moved {0};
+    probe_counters m_counters; //! counters of the rehashes, whose other counters stay zero
+
+    static void add(std::atomic<size_t>& counter, const size_t value) { counter.fetch_add(value, std::memory_order_relaxed); }
+
+    void assign(const probe_counters& counters) {
+        m_locates.store(counters.locates, std::memory_order_relaxed);
+        m_comparisons.store(counters.comparisons, std::memory_order_relaxed);
+        m_hits.store(counters.hits, std::memory_order_relaxed);
+        m_misses.store(counters.misses, std::memory_order_relaxed);
+        m_overflow_consults.store(counters.overflow_consults, std::memory_order_relaxed);
+        m_overflow_hits.store(counters.overflow_hits, std::memory_order_relaxed);
+        m_bucket_resizes.store(counters.bucket_resizes, std::memory_order_relaxed);
+        m_bytes_moved.store(counters.bytes_moved, std::memory_order_relaxed);
+        m_counters = probe_counters();
+        m_counters.rehashes = counters.rehashes;
+        m_counters.rehash_seconds = counters.rehash_seconds;
+    }
+
+    public:
+    static constexpr bool enabled = true;
+
+    counting_instrumentation() = default;
+    counting_instrumentation(const counting_instrumentation& other) { assign(other.counters()); }
+    counting_instrumentation& operator=(const counting_instrumentation& other) {
+        assign(other.counters());
+        return *this;
+    }
+
+    void locate(const size_t comparisons, const bool found) const {
+        add(m_locates, 1);
+        add(m_comparisons, comparisons);
+        add(found ? m_hits : m_misses, 1);
+    }
+    void overflow_consult(const bool found) const {
+        add(m_overflow_consults, 1);
+        add(m_overflow_hits, found);
+    }
+    void bucket_resize(const size_t bytes) {
+        add(m_bucket_resizes, 1);
+        add(m_bytes_moved, bytes);
+    }
+
+    //! measures the time of a rehash from its construction to its destruction
+    class rehash_timer {
+        counting_instrumentation& m_instrumentation;
+        const std::chrono::steady_clock::time_point m_start;
+        public:
+        rehash_timer(counting_instrumentation& instrumentation)
+            : m_instrumentation(instrumentation)
+            , m_start(std::chrono::steady_clock::now()) {}
+        ~rehash_timer() {
+            ++m_instrumentation.m_counters.rehashes;
+            m_instrumentation.m_counters.rehash_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+    };
+
+    //! a snapshot of the counters; taken during concurrent operations, each counter is exact, but the counters need not be consistent with each other
+    probe_counters counters() const {
+        probe_counters snapshot = m_counters;
+        snapshot.locates = m_locates.load(std::memory_order_relaxed);
+        snapshot.comparisons = m_comparisons.load(std::memory_order_relaxed);
+        snapshot.hits = m_hits.load(std::memory_order_relaxed);
+        snapshot.misses = m_misses.load(std::memory_order_relaxed);
+        snapshot.overflow_consults = m_overflow_consults.load(std::memory_order_relaxed);
+        snapshot.overflow_hits = m_overflow_hits.load(std::memory_order_relaxed);
+        snapshot.bucket_resizes = m_bucket_resizes.load(std::memory_order_relaxed);
+        snapshot.bytes_moved = m_bytes_moved.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+    void reset() { assign(probe_counters()); }
+};
+
+}//ns separate_chaining
@@ -44,16 +44,10 @@ struct separate_chaining_navigator {
 
         const key_type key()  const {
             DDCHECK(!invalid());
-            const uint_fast8_t key_bitwidth = m_map.m_hash.remainder_width(m_map.m_buckets);
-            DDCHECK_GT(key_bitwidth, 0);
-            DDCHECK_LE(key_bitwidth, m_map.key_width());
             if(m_map.m_overflow.size() > 0 && m_bucket == m_map.bucket_count()) {
                 return m_map.m_overflow.key(m_position);
             }
-
-            const storage_type read_quotient = m_map.quotient_at(m_bucket, m_position, key_bitwidth);
-            const key_type read_key = m_map.m_hash.inv_map(read_quotient, m_bucket, m_map.m_buckets);
-            return read_key;
+            return m_map.key_at(m_bucket, m_position);
         }
         //typename std::add_const<value_type>::type& value() const {
         value_type value() const {
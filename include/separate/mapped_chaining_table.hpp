@@ -0,0 +1,476 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dcheck.hpp"
+#include "math.hpp"
+#include "size.hpp"
+#include "iterator.hpp"
+#include "separate_chaining_table.hpp"
+
+namespace separate_chaining {
+
+/**
+ * Header of the contiguous on-disk layout written by `write_mapped`.
+ * All sections start at offsets that are multiples of eight bytes, and are stored in this order:
+ *  - the bucket starts: for each bucket `b` and for `b = bucket_count()`, a 16-bit integer storing the number of elements in the buckets `[b - (b mod MAPPED_SAMPLE_RATE), b)`
+ *  - the offset samples: the `i`-th sample is the number of elements stored in the buckets `[0, i*MAPPED_SAMPLE_RATE)`
+ *  - the quotients of all buckets, bit-packed with `m_quotient_width` bits each, bucket after bucket
+ *  - the values in the same order, bit-packed with `m_value_width` bits each (omitted for hash sets)
+ *  - the elements of the overflow table: the keys sorted ascendingly as 64-bit integers, followed by their values
+ *  - a zero word such that a bit-packed integer can be read with an unaligned 64-bit load
+ * Hence, the `b`-th bucket starts at the `(sample[b / MAPPED_SAMPLE_RATE] + start[b])`-th element, and its size is the difference to the start of bucket `b+1`.
+ */
+struct mapped_header {
+    static constexpr uint64_t MAGIC = 0x50414d4843504553ULL; //! "SEPCHMAP" in little endian
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t m_magic;
+    uint32_t m_version;
+    uint8_t m_has_values;
+    uint8_t m_key_width;
+    uint8_t m_value_width;
+    uint8_t m_buckets; //! log_2 of the number of buckets
+    uint8_t m_quotient_width;
+    uint8_t m_padding[7];
+    uint64_t m_elements; //! number of elements stored in the buckets
+    uint64_t m_overflow_elements; //! number of elements stored in the overflow section
+    uint64_t m_starts_offset;
+    uint64_t m_samples_offset;
+    uint64_t m_quotients_offset;
+    uint64_t m_values_offset;
+    uint64_t m_overflow_offset;
+    uint64_t m_file_size;
+};
+static_assert(sizeof(mapped_header) % sizeof(uint64_t) == 0, "sections need to be aligned to 64-bit words");
+
+static constexpr size_t MAPPED_SAMPLE_RATE = 64; //! number of buckets between two offset samples
+static_assert(MAPPED_SAMPLE_RATE * std::numeric_limits<bucketsize_type>::max() <= std::numeric_limits<uint16_t>::max(), "the bucket starts between two samples need to fit into 16 bits");
+
+//! reads `width` bits starting at bit `bit` of the bit-packed array `words`
+inline uint64_t read_packed(const uint64_t* words, const size_t bit, const uint_fast8_t width) {
+    DDCHECK_GT(width, 0);
+    DDCHECK_LE(width, 64);
+    const size_t word = bit >> 6;
+    const uint_fast8_t offset = bit & 63;
+    uint64_t value = words[word] >> offset;
+    if(offset + width > 64) { value |= words[word+1] << (64 - offset); }
+    return width == 64 ? value : value & ((1ULL<<width)-1);
+}
+
+//! appends integers of a fixed bit width to an output offering `write(const char*, size)` like `std::ostream`, word by word
+template<class output_type>
+class packed_writer {
+    output_type& m_os;
+    uint64_t m_word = 0;
+    uint_fast8_t m_filled = 0; //! number of bits of `m_word` already occupied
+    size_t m_words = 0; //! number of words written
+
+    public:
+    packed_writer(output_type& os) : m_os(os) {}
+
+    void write(const uint64_t value, const uint_fast8_t width) {
+        DDCHECK_LE(width, 64);
+        DDCHECK(width == 64 || (value >> width) == 0);
+        m_word |= value << m_filled;
+        if(m_filled + width < 64) {
+            m_filled += width;
+            return;
+        }
+        m_os.write(reinterpret_cast<const char*>(&m_word), sizeof(m_word));
+        ++m_words;
+        const uint_fast8_t written = 64 - m_filled;
+        m_word = written == 64 ? 0 : value >> written;
+        m_filled = width - written;
+    }
+    //! flushes a partially filled word, returns the number of written words
+    size_t finish() {
+        if(m_filled > 0) {
+            m_os.write(reinterpret_cast<const char*>(&m_word), sizeof(m_word));
+            ++m_words;
+            m_word = 0;
+            m_filled = 0;
+        }
+        return m_words;
+    }
+};
+
+//! whether a `separate_chaining_table` stores values, i.e., is not a hash set
+template<class table_type>
+struct mapped_has_values : std::integral_constant<bool, !std::is_same<typename table_type::value_manager_type, value_dummy_manager>::value> {};
+
+/**
+ * Computes the header of the layout of `table`, which gives the length of the layout in `m_file_size`.
+ * Throws if `table` has a pending incremental rehash, which has to be finished first with `finish_rehash()`.
+ */
+template<class table_type>
+mapped_header mapped_layout(const table_type& table) {
+    using value_type = typename table_type::value_type;
+    constexpr bool has_values = mapped_has_values<table_type>::value;
+    static_assert(!has_values || std::is_integral<value_type>::value, "only integer values can be bit-packed");
+    if(table.rehash_pending()) throw std::runtime_error("finish the pending rehash before writing the table");
+
+    const size_t cbucket_count = table.bucket_count();
+    const uint_fast8_t quotient_width = cbucket_count == 0 ? 1 : table.m_hash.remainder_width(table.bucket_count_log2());
+    const uint_fast8_t value_width = has_values ? table.value_width() : 0;
+
+    mapped_header header;
+    std::memset(&header, 0, sizeof(header));
+    header.m_magic = mapped_header::MAGIC;
+    header.m_version = mapped_header::VERSION;
+    header.m_has_values = has_values;
+    header.m_key_width = table.key_width();
+    header.m_value_width = value_width;
+    header.m_buckets = table.bucket_count_log2();
+    header.m_quotient_width = quotient_width;
+    header.m_overflow_elements = table.m_overflow.size();
+    header.m_elements = table.size() - header.m_overflow_elements;
+
+    const size_t sample_count = ceil_div<size_t>(cbucket_count, MAPPED_SAMPLE_RATE) + 1;
+    header.m_starts_offset = sizeof(mapped_header);
+    header.m_samples_offset = header.m_starts_offset + ceil_div<size_t>((cbucket_count+1) * sizeof(uint16_t), sizeof(uint64_t)) * sizeof(uint64_t);
+    header.m_quotients_offset = header.m_samples_offset + sample_count * sizeof(uint64_t);
+    header.m_values_offset = header.m_quotients_offset + ceil_div<size_t>(header.m_elements * quotient_width, 64) * sizeof(uint64_t);
+    header.m_overflow_offset = header.m_values_offset + ceil_div<size_t>(header.m_elements * value_width, 64) * sizeof(uint64_t);
+    header.m_file_size = header.m_overflow_offset + header.m_overflow_elements * (has_values ? 2 : 1) * sizeof(uint64_t) + sizeof(uint64_t);
+    return header;
+}
+
+/**
+ * Writes `table` in the contiguous layout described at `mapped_header` to `os`,
+ * such that it can be queried by a `mapped_chaining_table` without deserialization.
+ * `os` is a `std::ostream` or any other output offering `write(const char*, size)`.
+ * The keys and values have to be integers.
+ * Throws if `table` has a pending incremental rehash, which has to be finished first with `finish_rehash()`.
+ */
+template<class table_type, class output_type>
+void write_mapped(const table_type& table, output_type& os) {
+    constexpr bool has_values = mapped_has_values<table_type>::value;
+    const mapped_header header = mapped_layout(table);
+    const size_t cbucket_count = table.bucket_count();
+    const uint_fast8_t quotient_width = header.m_quotient_width;
+    const uint_fast8_t value_width = header.m_value_width;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const uint64_t zero = 0;
+    { // bucket starts
+        uint16_t start = 0;
+        for(size_t bucket = 0; bucket <= cbucket_count; ++bucket) {
+            if(bucket % MAPPED_SAMPLE_RATE == 0) { start = 0; }
+            os.write(reinterpret_cast<const char*>(&start), sizeof(start));
+            if(bucket < cbucket_count) { start += table.bucket_size(bucket); }
+        }
+        os.write(reinterpret_cast<const char*>(&zero), header.m_samples_offset - header.m_starts_offset - (cbucket_count+1) * sizeof(uint16_t));
+    }
+    { // offset samples
+        uint64_t offset = 0;
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            if(bucket % MAPPED_SAMPLE_RATE == 0) { os.write(reinterpret_cast<const char*>(&offset), sizeof(offset)); }
+            offset += table.bucket_size(bucket);
+        }
+        os.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        DDCHECK_EQ(offset, header.m_elements);
+    }
+    { // quotients
+        packed_writer<output_type> writer(os);
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            for(size_t position = 0; position < table.bucket_size(bucket); ++position) {
+                writer.write(table.quotient_at(bucket, position, quotient_width), quotient_width);
+            }
+        }
+        writer.finish();
+    }
+    if constexpr (has_values) {
+        packed_writer<output_type> writer(os);
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            for(size_t position = 0; position < table.bucket_size(bucket); ++position) {
+                writer.write(static_cast<uint64_t>(table.value_at(bucket, position)), value_width);
+            }
+        }
+        writer.finish();
+    }
+    if(header.m_overflow_elements > 0) {
+        std::vector<std::pair<uint64_t, uint64_t>> overflow;
+        overflow.reserve(header.m_overflow_elements);
+        for(size_t position = table.m_overflow.first_position(); overflow.size() < header.m_overflow_elements; position = table.m_overflow.next_position(position)) {
+            if(!table.m_overflow.valid_position(position)) continue;
+            overflow.emplace_back(table.m_overflow.key(position), static_cast<uint64_t>(table.m_overflow[position]));
+        }
+        std::sort(overflow.begin(), overflow.end());
+        for(const auto& el : overflow) { os.write(reinterpret_cast<const char*>(&el.first), sizeof(el.first)); }
+        if constexpr (has_values) {
+            for(const auto& el : overflow) { os.write(reinterpret_cast<const char*>(&el.second), sizeof(el.second)); }
+        }
+    }
+    os.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+}
+
+
+/**
+ * Read-only view on a hash table written by `write_mapped`, answering queries directly on the written layout.
+ * The layout is either memory-mapped from a file, such that opening a table takes constant time and
+ * several processes share the same pages of the page cache, or provided as a buffer in memory.
+ * It offers the query and iteration interface of `separate_chaining_table`.
+ *
+ * table_type: the type of the `separate_chaining_table` that has been written, providing the hash mapping
+ */
+template<class table_type>
+class mapped_chaining_table {
+    public:
+    using hash_mapping_type = typename table_type::hash_mapping_type;
+    using storage_type = typename table_type::storage_type;
+    using key_type = typename table_type::key_type;
+    using value_type = typename table_type::value_type;
+    using bucketsize_type = separate_chaining::bucketsize_type;
+    using size_type = uint64_t;
+    using class_type = mapped_chaining_table<table_type>;
+    using const_iterator = separate_chaining_iterator<const class_type>;
+    using const_navigator = separate_chaining_navigator<const class_type>;
+
+    //! the overflow section, offering the interface of an overflow table to the navigators
+    class overflow_view {
+        const uint64_t* m_keys = nullptr;
+        const uint64_t* m_values = nullptr;
+        size_t m_elements = 0;
+
+        public:
+        overflow_view() = default;
+        overflow_view(const uint64_t* keys, const uint64_t* values, size_t elements)
+            : m_keys(keys), m_values(values), m_elements(elements) {}
+
+        size_t size() const { return m_elements; }
+        bool valid_position(const size_t position) const { return position < m_elements; }
+        static constexpr size_t first_position() { return 0; }
+        size_t next_position(const size_t position) const { return position+1; }
+        size_t previous_position(const size_t position) const { DDCHECK_GT(position, 0); return position-1; }
+        key_type key(const size_t position) const {
+            DDCHECK_LT(position, m_elements);
+            return m_keys[position];
+        }
+        value_type operator[](const size_t position) const {
+            DDCHECK_LT(position, m_elements);
+            if(m_values == nullptr) { return value_type(); }
+            return static_cast<value_type>(m_values[position]);
+        }
+        //! returns the position of `key`, or -1 if it is not stored
+        size_t find(const key_type& key) const {
+            const uint64_t* it = std::lower_bound(m_keys, m_keys+m_elements, static_cast<uint64_t>(key));
+            if(it == m_keys+m_elements || *it != static_cast<uint64_t>(key)) return static_cast<size_t>(-1ULL);
+            return it - m_keys;
+        }
+    };
+
+    private:
+    const char* m_data; //! begin of the layout
+    size_t m_length; //! length of the layout in bytes
+    bool m_mapped; //! whether `m_data` is a memory mapping owned by this object
+    const mapped_header* m_header;
+    hash_mapping_type m_hash;
+    const uint16_t* m_starts;
+    const uint64_t* m_samples;
+    const uint64_t* m_quotients;
+    const uint64_t* m_values;
+
+    public:
+    overflow_view m_overflow;
+
+    private:
+    //! checks that `data` contains a layout written by `write_mapped` for `table_type`
+    static const mapped_header* parse(const char* data, const size_t length) {
+        if(length < sizeof(mapped_header)) throw std::runtime_error("mapped table is truncated");
+        DCHECK_EQ(reinterpret_cast<uintptr_t>(data) % alignof(uint64_t), 0);
+        const mapped_header* header = reinterpret_cast<const mapped_header*>(data);
+        if(header->m_magic != mapped_header::MAGIC) throw std::runtime_error("not a mapped separate chaining table");
+        if(header->m_version != mapped_header::VERSION) throw std::runtime_error("unsupported version of a mapped table");
+        if(header->m_has_values != mapped_has_values<table_type>::value) throw std::runtime_error("mapped table was written by a hash table of a different kind");
+        if(header->m_file_size > length) throw std::runtime_error("mapped table is truncated");
+        return header;
+    }
+
+    //! memory-maps the file `filename` for reading
+    static std::pair<const char*, size_t> map_file(const std::string& filename) {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("cannot open " + filename + ": " + std::strerror(errno));
+        struct stat st;
+        if(::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + filename + ": " + std::strerror(errno));
+        }
+        const size_t length = st.st_size;
+        void* data = length == 0 ? MAP_FAILED : ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(data == MAP_FAILED) throw std::runtime_error("cannot map " + filename + ": " + std::strerror(errno));
+        return { reinterpret_cast<const char*>(data), length };
+    }
+
+    mapped_chaining_table(const std::pair<const char*, size_t>& mapping, bool mapped)
+        : m_data(mapping.first)
+        , m_length(mapping.second)
+        , m_mapped(mapped)
+        , m_header(parse_or_unmap(mapping, mapped))
+        , m_hash(m_header->m_key_width)
+        , m_starts(reinterpret_cast<const uint16_t*>(m_data + m_header->m_starts_offset))
+        , m_samples(reinterpret_cast<const uint64_t*>(m_data + m_header->m_samples_offset))
+        , m_quotients(reinterpret_cast<const uint64_t*>(m_data + m_header->m_quotients_offset))
+        , m_values(reinterpret_cast<const uint64_t*>(m_data + m_header->m_values_offset))
+        , m_overflow(reinterpret_cast<const uint64_t*>(m_data + m_header->m_overflow_offset),
+                m_header->m_has_values ? reinterpret_cast<const uint64_t*>(m_data + m_header->m_overflow_offset) + m_header->m_overflow_elements : nullptr,
+                m_header->m_overflow_elements)
+    {}
+
+    static const mapped_header* parse_or_unmap(const std::pair<const char*, size_t>& mapping, bool mapped) {
+        try {
+            return parse(mapping.first, mapping.second);
+        } catch(...) {
+            if(mapped) { ::munmap(const_cast<char*>(mapping.first), mapping.second); }
+            throw;
+        }
+    }
+
+    //! returns the number of elements stored in the buckets before `bucket`
+    size_t bucket_offset(const size_t bucket) const {
+        return m_samples[bucket / MAPPED_SAMPLE_RATE] + m_starts[bucket];
+    }
+
+    public:
+    //! memory-maps the table written to the file `filename`
+    mapped_chaining_table(const std::string& filename)
+        : mapped_chaining_table(map_file(filename), true) {}
+
+    //! views the table written to the buffer `data` of `length` bytes, which has to outlive this object and be aligned to 64-bit words
+    mapped_chaining_table(const char* data, const size_t length)
+        : mapped_chaining_table(std::make_pair(data, length), false) {}
+
+    mapped_chaining_table(const mapped_chaining_table&) = delete;
+    mapped_chaining_table& operator=(const mapped_chaining_table&) = delete;
+    mapped_chaining_table(mapped_chaining_table&& other)
+        : m_data(other.m_data), m_length(other.m_length), m_mapped(other.m_mapped), m_header(other.m_header), m_hash(std::move(other.m_hash))
+        , m_starts(other.m_starts), m_samples(other.m_samples), m_quotients(other.m_quotients), m_values(other.m_values)
+        , m_overflow(other.m_overflow) {
+        other.m_mapped = false;
+    }
+
+    ~mapped_chaining_table() {
+        if(m_mapped) { ::munmap(const_cast<char*>(m_data), m_length); }
+    }
+
+    //! returns the maximum value of a key that can be stored
+    key_type max_key() const { return key_width() == 0 ? 0 : (-1ULL) >> (64-key_width()); }
+    uint_fast8_t key_width() const { return m_header->m_key_width; }
+    //! returns the maximum value that can be stored, which is 0 for a layout without values
+    value_type max_value() const { return value_width() == 0 ? 0 : (-1ULL) >> (64 - value_width()); }
+    uint_fast8_t value_width() const { return m_header->m_value_width; }
+
+    //! @see std::unordered_map
+    size_t size() const { return m_header->m_elements + m_header->m_overflow_elements; }
+    bool empty() const { return size() == 0; }
+
+    size_type bucket_count() const {
+        if(m_header->m_buckets == 0) return 0;
+        return 1ULL<<m_header->m_buckets;
+    }
+    uint_fast8_t bucket_count_log2() const { return m_header->m_buckets; }
+    bucketsize_type bucket_size(size_type n) const { return bucket_offset(n+1) - bucket_offset(n); }
+
+    //! number of bytes of the layout
+    size_type size_in_bytes() const { return m_header->m_file_size; }
+
+    storage_type quotient_at(const size_t bucket, const size_t position, const uint_fast8_t quotient_width) const {
+        DDCHECK_LT(bucket, bucket_count());
+        DDCHECK_LT(position, bucket_size(bucket));
+        return read_packed(m_quotients, (bucket_offset(bucket) + position) * quotient_width, quotient_width);
+    }
+    value_type value_at(const size_t bucket, const size_t position) const {
+        if(bucket == bucket_count()) { return m_overflow[position]; }
+        DDCHECK_LT(bucket, bucket_count());
+        DDCHECK_LT(position, bucket_size(bucket));
+        if constexpr (!mapped_has_values<table_type>::value) { return value_type(); }
+        else { return static_cast<value_type>(read_packed(m_values, (bucket_offset(bucket) + position) * value_width(), value_width())); }
+    }
+    key_type key_at(const size_t bucket, const size_t position) const {
+        return m_hash.inv_map(quotient_at(bucket, position, m_header->m_quotient_width), bucket, m_header->m_buckets);
+    }
+
+    //! returns the position of the key with quotient `quotient` in `bucket`, or -1 if it is not stored there
+    size_t locate(const size_t& bucket, const storage_type& quotient) const {
+        const uint_fast8_t quotient_width = m_header->m_quotient_width;
+        const size_t offset = bucket_offset(bucket);
+        const size_t bucket_size = bucket_offset(bucket+1) - offset;
+        if(quotient_width == 64) {
+            const uint64_t* quotients = m_quotients + offset;
+            for(size_t position = 0; position < bucket_size; ++position) {
+                if(quotients[position] == static_cast<uint64_t>(quotient)) return position;
+            }
+        } else if(quotient_width <= 56) { // every quotient fits into an unaligned 64-bit load starting at its first byte
+            const char* bytes = reinterpret_cast<const char*>(m_quotients);
+            const uint64_t mask = (1ULL<<quotient_width)-1;
+            size_t bit = offset * quotient_width;
+            for(size_t position = 0; position < bucket_size; ++position, bit += quotient_width) {
+                uint64_t word;
+                std::memcpy(&word, bytes + (bit >> 3), sizeof(word));
+                if(((word >> (bit & 7)) & mask) == static_cast<uint64_t>(quotient)) return position;
+            }
+        } else {
+            size_t bit = offset * quotient_width;
+            for(size_t position = 0; position < bucket_size; ++position, bit += quotient_width) {
+                if(read_packed(m_quotients, bit, quotient_width) == static_cast<uint64_t>(quotient)) return position;
+            }
+        }
+        return static_cast<size_t>(-1ULL);
+    }
+
+    const_iterator find(const key_type& key) const {
+        if(m_header->m_buckets == 0) return cend();
+        if(m_overflow.size() > 0) {
+            const size_t position = m_overflow.find(key);
+            if(position != static_cast<size_t>(-1ULL)) {
+                return const_iterator { *this, bucket_count(), position };
+            }
+        }
+        const auto [quotient, bucket] = m_hash.map(key, m_header->m_buckets);
+        const size_t position = locate(bucket, quotient);
+        if(position == static_cast<size_t>(-1ULL)) { return cend(); }
+        return const_iterator { *this, bucket, position };
+    }
+
+    //! @see std::set
+    size_type count(const key_type& key) const {
+        return find(key) == cend() ? 0 : 1;
+    }
+
+    const const_iterator cend() const { return { *this, -1ULL, -1ULL }; }
+    const const_iterator cbegin() const {
+        const size_t cbucket_count = bucket_count();
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            if(bucket_size(bucket) > 0) { return { *this, bucket, 0 }; }
+        }
+        if(m_overflow.size() > 0) return { *this, cbucket_count, 0 };
+        return cend();
+    }
+    const const_navigator cend_nav() const { return { *this, -1ULL, -1ULL }; }
+    const const_navigator cbegin_nav() const {
+        const size_t cbucket_count = bucket_count();
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            if(bucket_size(bucket) > 0) { return { *this, bucket, 0 }; }
+        }
+        if(m_overflow.size() > 0) return { *this, cbucket_count, 0 };
+        return cend_nav();
+    }
+};
+
+}//ns separate_chaining
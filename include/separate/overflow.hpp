@@ -1,5 +1,9 @@
 #pragma once
 #include <tudocomp/ds/IntVector.hpp>
+#include <type_traits>
+#include "bucket.hpp"
+#include "hash.hpp"
+#include "math.hpp"
 
 #ifndef ARRAY_OVERFLOW_LENGTH
 constexpr size_t ARRAY_OVERFLOW_LENGTH = 256;
@@ -114,7 +118,7 @@ namespace separate_chaining {
         }
         void erase(const size_t position) {
             DCHECK_LT(position, m_elements);
-            for(size_t i = m_elements; i < position; --i) {
+            for(size_t i = position+1; i < m_elements; ++i) {
               m_keys.write(i-1, m_keys.read(i,0),  0);
               m_values.write(i-1, m_values.read(i,0),  0);
             }
@@ -144,7 +148,7 @@ namespace separate_chaining {
           return m_bucketfull[bucket];
         }
         size_t find(const key_type& key) const { // returns position of key
-            return m_keys.find(key, m_length, 0);
+            return m_keys.find(key, m_elements, 0);
         }
         value_type& operator[](const size_t index) { // returns value
             DCHECK_LT(index, m_length);
@@ -289,3 +293,246 @@ namespace separate_chaining {
 
 }//ns
 
+namespace separate_chaining {
+
+  /**
+   * Overflow table storing up to `ARRAY_OVERFLOW_LENGTH` elements, with expected constant time for `find`, `insert` and `erase`.
+   * The elements occupy the positions [0, size()) densely, such that iterating over them visits no empty slots.
+   * A key is mapped bijectively to a `key_width`-bit hash value, whose highest bits select the home slot in an open addressing table with linear probing
+   * of at least twice as many slots as elements. The lowest bits cannot be used since the tables select a bucket with the lowest bits of the same bijection,
+   * such that all elements overflowing from one bucket share them. A slot stores the position of its element and the remaining bits of the hash value (the quotient),
+   * such that probing compares quotients without accessing the elements. An element stores its home slot and its value with `value_width` bits.
+   * Since the values are bit-packed, `operator[]` returns a proxy that converts to and can be assigned a `value_type`.
+   * `erase` moves the last element into the erased position.
+   */
+  template<class key_t, class value_t>
+    class hashed_overflow {
+        public:
+        using key_type = key_t;
+        using value_type = value_t;
+        static_assert(std::is_integral<key_type>::value && std::is_integral<value_type>::value, "hashed_overflow bit-packs integer keys and values");
+
+        private:
+        static constexpr size_t m_length = ARRAY_OVERFLOW_LENGTH;
+        static constexpr uint_fast8_t m_slot_bits = bit_width(2*m_length-1); //! log2 of the number of slots
+        static constexpr size_t m_slots = 1ULL<<m_slot_bits;
+        static constexpr uint_fast8_t m_position_bits = bit_width(m_length); //! a slot stores its position plus one, zero marks an empty slot
+
+        uint_fast8_t m_key_width;
+        uint_fast8_t m_value_width;
+        bijective_hash_adapter<uint64_t, uint64_t> m_hash;
+        varwidth_bucket<uint64_t> m_slot_entries; //! quotient and position+1 of each slot
+        varwidth_bucket<uint64_t> m_homes; //! home slot of each position
+        varwidth_bucket<uint64_t> m_values; //! value of each position
+        size_t m_elements = 0;
+        tdc::BitVector m_bucketfull;
+
+        uint_fast8_t quotient_width() const { return m_key_width > m_slot_bits ? m_key_width - m_slot_bits : 0; }
+        uint_fast8_t slot_width() const { return m_position_bits + quotient_width(); }
+        static constexpr size_t next_slot(const size_t slot) { return (slot+1) & (m_slots-1); }
+
+        //! position+1 of the element stored in `slot`, or zero if `slot` is empty
+        size_t slot_position(const size_t slot) const {
+            return m_slot_entries.read(slot, slot_width()) & ((1ULL<<m_position_bits)-1);
+        }
+        uint64_t slot_quotient(const size_t slot) const {
+            return m_slot_entries.read(slot, slot_width()) >> m_position_bits;
+        }
+        void write_slot(const size_t slot, const uint64_t quotient, const size_t position_plus_one) {
+            m_slot_entries.write(slot, (quotient << m_position_bits) | position_plus_one, slot_width());
+        }
+        size_t home(const size_t position) const { return m_homes.read(position, m_slot_bits); }
+
+        //! splits the hash value of `key` into the quotient (its lowest `quotient_width()` bits) and the home slot (its remaining highest bits)
+        std::pair<uint64_t, size_t> map(const key_type& key) const {
+            const uint64_t hash_value = m_hash.map(key, 0).first;
+            return { hash_value & ((1ULL<<quotient_width())-1), hash_value >> quotient_width() };
+        }
+        key_type inv_map(const uint64_t quotient, const size_t home_slot) const {
+            return static_cast<key_type>(m_hash.inv_map(home_slot, quotient, quotient_width()));
+        }
+
+        //! the slot storing the element at `position`
+        size_t slot_of(const size_t position) const {
+            size_t slot = home(position);
+            while(slot_position(slot) != position+1) {
+                DDCHECK_NE(slot_position(slot), 0);
+                slot = next_slot(slot);
+            }
+            return slot;
+        }
+
+        void allocate() {
+            m_slot_entries.initialize(m_slots, slot_width());
+            m_homes.initialize(m_length, m_slot_bits);
+            m_values.initialize(m_length, m_value_width);
+            for(size_t slot = 0; slot < m_slots; ++slot) { m_slot_entries.write(slot, 0, slot_width()); }
+        }
+
+        //! empties `slot` and moves subsequent elements of the probe sequence backwards, such that no probe sequence contains an empty slot
+        void remove_slot(size_t slot) {
+            for(size_t next = next_slot(slot); slot_position(next) != 0; next = next_slot(next)) {
+                const size_t next_home = home(slot_position(next)-1);
+                //! the element in `next` can move to `slot` if its home does not lie cyclically in (slot, next]
+                const bool in_between = slot <= next ? (slot < next_home && next_home <= next) : (slot < next_home || next_home <= next);
+                if(in_between) { continue; }
+                write_slot(slot, slot_quotient(next), slot_position(next));
+                slot = next;
+            }
+            write_slot(slot, 0, 0);
+        }
+
+        public:
+        //! reference to a bit-packed value
+        class value_reference {
+            hashed_overflow& m_overflow;
+            const size_t m_position;
+            public:
+            value_reference(hashed_overflow& overflow, const size_t position) : m_overflow(overflow), m_position(position) {}
+            operator value_type() const { return m_overflow.value(m_position); }
+            value_reference& operator=(const value_type& value) {
+                m_overflow.write_value(m_position, value);
+                return *this;
+            }
+            value_reference& operator=(const value_reference& other) { return operator=(static_cast<value_type>(other)); }
+        };
+
+        size_t size() const { return m_elements; }
+        size_t capacity() const { return m_length; }
+
+        bool valid_position(const size_t position) const { return position < size(); } //! is position a valid entry of the table?
+
+        hashed_overflow(uint_fast8_t key_width, uint_fast8_t value_width)
+            : m_key_width(key_width), m_value_width(value_width), m_hash(key_width)
+        {
+            DDCHECK_GE(m_value_width, 1);
+            allocate();
+        }
+        hashed_overflow(hashed_overflow&&) = default;
+        hashed_overflow& operator=(hashed_overflow&&) = default;
+
+        static constexpr size_t first_position() { return 0; }
+        size_t next_position(const size_t position) const {
+          DCHECK_LT(position, m_length);
+          return position+1;
+        }
+        size_t previous_position(const size_t position) const {
+          DCHECK_GT(position,0);
+          return position-1;
+        }
+
+        void deserialize(std::istream& is) {
+            m_slot_entries.clear();
+            m_homes.clear();
+            m_values.clear();
+            is.read(reinterpret_cast<char*>(&m_key_width), sizeof(decltype(m_key_width)));
+            is.read(reinterpret_cast<char*>(&m_value_width), sizeof(decltype(m_value_width)));
+            is.read(reinterpret_cast<char*>(&m_elements), sizeof(decltype(m_elements)));
+            m_hash = decltype(m_hash)(m_key_width);
+            m_slot_entries.deserialize(is, m_slots, slot_width());
+            m_homes.deserialize(is, m_elements, m_slot_bits);
+            m_values.deserialize(is, m_elements, m_value_width);
+            m_homes.resize(m_elements, m_length, m_slot_bits);
+            m_values.resize(m_elements, m_length, m_value_width);
+        }
+        void serialize(std::ostream& os) const {
+            os.write(reinterpret_cast<const char*>(&m_key_width), sizeof(decltype(m_key_width)));
+            os.write(reinterpret_cast<const char*>(&m_value_width), sizeof(decltype(m_value_width)));
+            os.write(reinterpret_cast<const char*>(&m_elements), sizeof(decltype(m_elements)));
+            m_slot_entries.serialize(os, m_slots, slot_width());
+            m_homes.serialize(os, m_elements, m_slot_bits);
+            m_values.serialize(os, m_elements, m_value_width);
+        }
+
+        size_t size_in_bytes() const {
+            return m_bucketfull.bit_size()/8 + decltype(m_slot_entries)::size_in_bytes(m_slots, slot_width()) 
+                + decltype(m_homes)::size_in_bytes(m_length, m_slot_bits) + decltype(m_values)::size_in_bytes(m_length, m_value_width) + sizeof(*this);
+        }
+        //! removes all elements, but keeps the memory
+        void clear() {
+            for(size_t slot = 0; slot < m_slots; ++slot) { m_slot_entries.write(slot, 0, slot_width()); }
+            m_elements = 0;
+        }
+        void erase(const size_t position) {
+            DCHECK_LT(position, m_elements);
+            remove_slot(slot_of(position));
+            const size_t last = m_elements-1;
+            if(position != last) {
+                const size_t last_slot = slot_of(last);
+                write_slot(last_slot, slot_quotient(last_slot), position+1);
+                m_homes.write(position, home(last), m_slot_bits);
+                m_values.write(position, m_values.read(last, m_value_width), m_value_width);
+            }
+            --m_elements;
+        }
+        /*
+         * @bucket: the bucket in which we wanted to insert the (key,value) pair
+         *
+         * inserts a (key,value) pair whose key is not yet stored
+         * returns the position of this pair, or -1 if the table is full
+         */
+        size_t insert(const size_t bucket, const key_type& key, const value_type& value) {
+            if(m_elements == m_length) return static_cast<size_t>(-1ULL);
+            DDCHECK_EQ(find(key), static_cast<size_t>(-1ULL));
+            m_bucketfull[bucket] = true;
+            const auto [quotient, home_slot] = map(key);
+            size_t slot = home_slot;
+            while(slot_position(slot) != 0) { slot = next_slot(slot); }
+            write_slot(slot, quotient, m_elements+1);
+            m_homes.write(m_elements, home_slot, m_slot_bits);
+            write_value(m_elements, value);
+            return m_elements++;
+        }
+        /**
+         * The bits of `m_bucketfull` are not recomputed for the new number of buckets.
+         * The table reinserts the elements of the overflow table when growing; only deserialized elements can be left,
+         * for which all buckets are marked since their buckets are not known.
+         */
+        void resize_buckets(size_t bucketcount, uint_fast8_t, uint_fast8_t) {
+          m_bucketfull.resize(bucketcount);
+          if(m_elements > 0) {
+              for(size_t bucket = 0; bucket < bucketcount; ++bucket) { m_bucketfull[bucket] = true; }
+          }
+        }
+
+        bool need_consult(size_t bucket) const {
+          DCHECK_LT(bucket, m_bucketfull.size());
+          return m_bucketfull[bucket];
+        }
+        size_t find(const key_type& key) const { // returns position of key
+            const auto [quotient, home_slot] = map(key);
+            for(size_t slot = home_slot; slot_position(slot) != 0; slot = next_slot(slot)) {
+                if(slot_quotient(slot) == quotient && home(slot_position(slot)-1) == home_slot) {
+                    return slot_position(slot)-1;
+                }
+            }
+            return static_cast<size_t>(-1ULL);
+        }
+        value_type value(const size_t position) const {
+            DCHECK_LT(position, m_elements);
+            return static_cast<value_type>(m_values.read(position, m_value_width));
+        }
+        void write_value(const size_t position, const value_type& value) {
+            DCHECK_LT(position, m_length);
+            m_values.write(position, static_cast<uint64_t>(value), m_value_width);
+        }
+        value_reference operator[](const size_t index) { // returns value
+            DCHECK_LT(index, m_length);
+            return { *this, index };
+        }
+        value_type operator[](const size_t index) const {
+            return value(index);
+        }
+        key_type key(const size_t index) const {
+            DCHECK_LT(index, m_elements);
+            const size_t slot = slot_of(index);
+            return inv_map(slot_quotient(slot), home(index));
+        }
+        //! the number of slots `find` probes after the home slot until reaching the element at `position`
+        size_t probe_length(const size_t position) const {
+            DCHECK_LT(position, m_elements);
+            return (slot_of(position) - home(position)) & (m_slots-1);
+        }
+    };
+
+}//ns
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <limits>
+#include <optional>
 #include "hash.hpp"
 #include "bucket.hpp"
 #include "size.hpp"
+#include "allocator.hpp"
 #include "overflow.hpp"
+#include "stats.hpp"
+#include "instrumentation.hpp"
 #if STATS_ENABLED
 #include <tudocomp_stat/StatPhase.hpp>
 #endif
@@ -32,14 +38,19 @@ class null_value_bucket {
     }
 	constexpr void erase(const size_t, const size_t, const uint_fast8_t) {}
     constexpr void clear() {}
+    constexpr void prefetch() const {}
     constexpr void initialize(size_t,uint_fast8_t) {}
+    template<class allocator_t> constexpr void initialize(size_t,uint_fast8_t,allocator_t&) {}
     constexpr void resize([[maybe_unused]] const size_t oldsize, [[maybe_unused]] const size_t size, [[maybe_unused]] const size_t width) {}
+    template<class allocator_t> constexpr void resize(const size_t, const size_t, const size_t, allocator_t&) {}
     null_value_bucket(null_value_bucket&&) {}
     null_value_bucket() = default;
     static constexpr void deserialize([[maybe_unused]] std::istream& is, [[maybe_unused]] const size_t length, [[maybe_unused]] const uint_fast8_t width) { }
+    template<class allocator_t> static constexpr void deserialize(std::istream&, const size_t, const uint_fast8_t, allocator_t&) { }
 
     static constexpr void serialize([[maybe_unused]] std::ostream& os, [[maybe_unused]] const size_t length, [[maybe_unused]] const uint_fast8_t width) { }
     static constexpr void write([[maybe_unused]] const size_t i, [[maybe_unused]] const storage_type key, [[maybe_unused]] const uint_fast8_t width = 0) {}
+    static constexpr size_t size_in_bytes(const size_t, const size_t = 0) { return 0; }
 };
 
 //! dummy class for supporting hash sets without memory overhead
@@ -52,6 +63,8 @@ class value_dummy_manager {
     static null_value_bucket m_bucket;
 
     public:
+    static constexpr size_t bytes_per_bucket = 0; //! no value bucket is stored per bucket
+
     value_dummy_manager() = default;
     value_dummy_manager(value_dummy_manager&&) { }
     value_dummy_manager& operator=(value_dummy_manager&&) { return *this; }
@@ -85,6 +98,8 @@ class value_array_manager {
     value_bucket_type* m_values = nullptr; //! bucket for values
 
     public:
+    static constexpr size_t bytes_per_bucket = sizeof(value_bucket_type); //! size of the entry of a bucket in the array of value buckets
+
     value_array_manager() = default;
     value_array_manager(value_array_manager&& o) : m_values(std::move(o.m_values)) { }
     value_array_manager& operator=(value_array_manager&& o) { 
@@ -124,9 +139,20 @@ class value_array_manager {
  * value_manager_t: Either `value_dummy_manager` or `value_array_manager<value_bucket_t>`, where `value_bucket_t` is either `class_bucket_t` or `plain_bucket_t`
  * hash_mapping_t: a hash mapping from `hash.hpp`
  * resize_strategy_t: either `arbitrary_resize` or `incremental_resize`
+ * allocator_t: either `malloc_allocator` or `slab_allocator` from `allocator.hpp`, which has to match the allocator of the buckets
+ * erase_policy_t: either `ordered_erase`, keeping the order of the elements in a bucket, or `unordered_erase`, filling the gap of an erased element with the last element of its bucket
+ * instrumentation_t: either `no_instrumentation` or `counting_instrumentation` from `instrumentation.hpp`, the latter counting bucket scans, reallocations and rehashes, @see counters()
+ *
+ * Thread safety: the const member functions (e.g., `find`, `locate`, `count`, `cbegin`/`cend`, `find_batch`, `serialize`) and const navigators
+ * do not modify any state, such that any number of threads can call them concurrently on a table that is not modified meanwhile.
+ * The only exception are the counters of `counting_instrumentation` updated by `find` and `locate`, which are relaxed atomics for that reason.
+ * For concurrent modifications, see `sharded_chaining_map` and `striped_chaining_map`.
  */
 template<class key_bucket_t, class value_manager_t, class hash_mapping_t, class resize_strategy_t, 
-    template<class K, class V> class overflow_t
+    template<class K, class V> class overflow_t,
+    class allocator_t = malloc_allocator,
+    class erase_policy_t = ordered_erase,
+    class instrumentation_t = no_instrumentation
     >
 class separate_chaining_table {
     public:
@@ -151,7 +177,12 @@ class separate_chaining_table {
 
     using bucketsize_type = separate_chaining::bucketsize_type; //! used for storing the sizes of the buckets
     using size_type = uint64_t; //! used for addressing the i-th bucket
-    using class_type = separate_chaining_table<key_bucket_type, value_manager_type, hash_mapping_type, resize_strategy_type, overflow_t>;
+    using allocator_type = allocator_t; //! allocator of the key and value buckets
+    using erase_policy_type = erase_policy_t; //! how an element is removed from its bucket
+    using instrumentation_type = instrumentation_t; //! counts the operations on the hot paths, or does nothing by default
+    using class_type = separate_chaining_table<key_bucket_type, value_manager_type, hash_mapping_type, resize_strategy_type, overflow_t, allocator_type, erase_policy_type, instrumentation_type>;
+    static_assert(is_allocator_compatible<key_bucket_type, allocator_type>::value, "the key bucket needs to use the allocator of the hash table!");
+    static_assert(is_allocator_compatible<value_bucket_type, allocator_type>::value, "the value bucket needs to use the allocator of the hash table!");
     using iterator = separate_chaining_iterator<class_type>;
     using const_iterator = separate_chaining_iterator<const class_type>;
     using navigator = separate_chaining_navigator<class_type>;
@@ -160,6 +191,7 @@ class separate_chaining_table {
     static_assert(MAX_BUCKET_BYTESIZE/sizeof(key_type) <= std::numeric_limits<bucketsize_type>::max(), "enlarge separate_chaining::MAX_BUCKET_BYTESIZE for this key type!");
 
     resize_strategy_type m_resize_strategy;
+    allocator_type m_allocator; //! provides the memory of the key and value buckets, declared before them such that it is destroyed after them
 
     // static constexpr size_t MAX_BUCKETSIZE = separate_chaining::MAX_BUCKET_BYTESIZE/sizeof(key_type); //TODO: make constexpr
 
@@ -173,9 +205,26 @@ class separate_chaining_table {
     size_t m_elements = 0; //! number of stored elements
     uint_fast8_t m_key_width;
     uint_fast8_t m_value_width;
+    instrumentation_type m_instrumentation; //! declared next to the widths such that `no_instrumentation` fits into their padding
     hash_mapping_type m_hash; //! hash function
 
-    mutable overflow_type m_overflow; //TODO: cht_overflow has non-const operations
+    overflow_type m_overflow;
+
+    /**
+     * Incremental rehashing: while a rehash is pending, `m_rehash_source` holds the buckets before the table grew.
+     * A non-empty bucket `b` of `m_rehash_source` has not been migrated yet, and the buckets `b` and `b + m_rehash_source->bucket_count()`
+     * of this table are empty. To the outside, the source bucket `b` takes the place of the bucket `b` of this table.
+     */
+    separate_chaining_table* m_rehash_source = nullptr;
+    size_t m_rehash_cursor = 0; //! all buckets of `m_rehash_source` before this one are migrated
+    size_t m_rehash_step = 0; //! number of non-empty buckets migrated per insertion or erasure, 0 disables incremental rehashing
+    float m_min_load_factor = 0; //! an erasure letting `load_factor()` drop below this value halves the number of buckets, 0 disables shrinking
+    growth_policy m_growth; //! decides when an insertion doubles the number of buckets
+
+    //! number of bytes of a key and a value bucket with `capacity` elements, reported to `m_instrumentation` on a reallocation
+    size_t bucket_bytes(const size_t capacity) const {
+        return key_bucket_type::size_in_bytes(capacity, m_hash.remainder_width(m_buckets)) + value_bucket_type::size_in_bytes(capacity, value_width());
+    }
 
     //! shrinks a bucket to its real size
     void shrink_to_fit(size_t bucket) {
@@ -186,8 +235,9 @@ class separate_chaining_table {
         const bucketsize_type& bucket_size = m_bucketsizes[bucket];
         if(bucket_size == 0) return;
         if(m_resize_strategy.can_shrink(bucket_size, bucket)) { 
-            m_keys[bucket].resize(bucket_size, bucket_size, key_bitwidth);
-            m_value_manager[bucket].resize(bucket_size, bucket_size, value_width());
+            m_instrumentation.bucket_resize(bucket_bytes(m_resize_strategy.size(bucket_size, bucket)));
+            m_keys[bucket].resize(bucket_size, bucket_size, key_bitwidth, m_allocator);
+            m_value_manager[bucket].resize(bucket_size, bucket_size, value_width(), m_allocator);
             m_resize_strategy.assign(bucket_size, bucket);
         }
     }
@@ -199,6 +249,22 @@ class separate_chaining_table {
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
             shrink_to_fit(bucket);
         }
+        if(m_rehash_source != nullptr) { m_rehash_source->shrink_to_fit(); }
+    }
+
+    //! the allocator providing the memory of the buckets
+    const allocator_type& allocator() const { return m_allocator; }
+
+    //! reports the memory held by the allocator of the buckets, e.g., to measure the fragmentation of a `slab_allocator`
+    allocator_stats allocation_stats() const {
+        allocator_stats stats = m_allocator.stats();
+        if(m_rehash_source != nullptr) {
+            const allocator_stats source_stats = m_rehash_source->allocation_stats();
+            stats.slabs += source_stats.slabs;
+            stats.reserved_bytes += source_stats.reserved_bytes;
+            stats.used_bytes += source_stats.used_bytes;
+        }
+        return stats;
     }
 
     //!@see std::vector
@@ -208,6 +274,7 @@ class separate_chaining_table {
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
             size += m_resize_strategy.size(m_bucketsizes[bucket], bucket);
         }
+        if(m_rehash_source != nullptr) { size += m_rehash_source->capacity(); }
         return size;
     }
 
@@ -241,6 +308,11 @@ class separate_chaining_table {
      * Cleans up the hash table. Sets the hash table in its initial state.
      */
     void clear() { //! empties hash table
+        if(m_rehash_source != nullptr) {
+            delete m_rehash_source;
+            m_rehash_source = nullptr;
+            m_rehash_cursor = 0;
+        }
         const size_t cbucket_count = bucket_count();
         if(m_bucketsizes != nullptr) {
             for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
@@ -252,6 +324,7 @@ class separate_chaining_table {
         else {
           m_overflow.clear(); // needs extra call
         }
+        m_allocator.clear();
     }
 
     public:
@@ -266,8 +339,25 @@ class separate_chaining_table {
             return m_overflow[position];
         }
         DCHECK_LT(bucket, bucket_count());
+        if(is_source_bucket(bucket)) { return m_rehash_source->value_at(bucket, position); }
         return m_value_manager[bucket].read(position, value_width());
     }
+    //! returns the key stored at position `position` of bucket `bucket`
+    key_type key_at(const size_t bucket, const size_t position) const {
+        DCHECK_LT(bucket, bucket_count());
+        if(is_source_bucket(bucket)) { return m_rehash_source->key_at(bucket, position); }
+        const uint_fast8_t key_bitwidth = m_hash.remainder_width(m_buckets);
+        DDCHECK_GT(key_bitwidth, 0);
+        DDCHECK_LE(key_bitwidth, key_width());
+        return m_hash.inv_map(quotient_at(bucket, position, key_bitwidth), bucket, m_buckets);
+    }
+
+    private:
+    //! whether `bucket` is represented by a not yet migrated bucket of `m_rehash_source`
+    bool is_source_bucket(const size_t bucket) const {
+        return m_rehash_source != nullptr && bucket < m_rehash_source->bucket_count() && m_rehash_source->m_bucketsizes[bucket] > 0;
+    }
+    public:
 
     //! returns the maximum value of a key that can be stored
     key_type max_key() const { return (-1ULL) >> (64-m_key_width); }
@@ -288,8 +378,21 @@ class separate_chaining_table {
 
     //! the maximum number of elements that can be stored with the current number of buckets.
     size_type max_size() const noexcept {
-        return max_bucket_size() * bucket_count();
+        return bucket_cap() * bucket_count();
+    }
+
+    //! number of elements at which a bucket counts as full, set by the growth policy and at most `max_bucket_size()`
+    size_t bucket_cap() const {
+        return std::min<size_t>(m_growth.bucket_cap, max_bucket_size());
+    }
+
+    //! sets the policy deciding when an insertion doubles the number of buckets, @see growth_policy
+    void growth(const growth_policy& policy) {
+        if(policy.bucket_cap == 0) { throw std::runtime_error("the bucket cap of a growth policy has to be positive"); }
+        if(policy.max_load_factor < 0 || policy.hot_load_factor < 0) { throw std::runtime_error("the load factors of a growth policy must not be negative"); }
+        m_growth = policy;
     }
+    const growth_policy& growth() const { return m_growth; }
 
     static constexpr size_t max_bucket_size() { //! largest number of elements a bucket can contain before enlarging the hash table
     #ifdef SEPARATE_MAX_BUCKET_SIZE
@@ -311,6 +414,7 @@ class separate_chaining_table {
 
     //! @see std::unordered_map
     bucketsize_type bucket_size(size_type n) const {
+        if(is_source_bucket(n)) { return m_rehash_source->m_bucketsizes[n]; }
         return m_bucketsizes[n];
     }
 
@@ -329,6 +433,7 @@ class separate_chaining_table {
     separate_chaining_table(separate_chaining_table&& other)
        : m_key_width(other.m_key_width)
        , m_value_width(other.m_value_width)
+       , m_instrumentation(std::move(other.m_instrumentation))
        , m_keys(std::move(other.m_keys))
        , m_value_manager(std::move(other.m_value_manager))
        , m_bucketsizes(std::move(other.m_bucketsizes))
@@ -336,11 +441,18 @@ class separate_chaining_table {
        , m_elements(std::move(other.m_elements))
        , m_hash(std::move(other.m_hash))
        , m_resize_strategy(std::move(other.m_resize_strategy))
+       , m_allocator(std::move(other.m_allocator))
        , m_overflow(std::move(other.m_overflow))
+       , m_rehash_source(std::move(other.m_rehash_source))
+       , m_rehash_cursor(std::move(other.m_rehash_cursor))
+       , m_rehash_step(std::move(other.m_rehash_step))
+       , m_min_load_factor(std::move(other.m_min_load_factor))
+       , m_growth(std::move(other.m_growth))
     {
 
         ON_DEBUG(m_plainkeys = std::move(other.m_plainkeys); other.m_plainkeys = nullptr;)
         other.m_bucketsizes = nullptr; //! a hash map without buckets is already deleted
+        other.m_rehash_source = nullptr;
     }
 
     separate_chaining_table& operator=(separate_chaining_table&& other) {
@@ -355,9 +467,17 @@ class separate_chaining_table {
         m_hash        = std::move(other.m_hash);
         m_elements    = std::move(other.m_elements);
         m_resize_strategy = std::move(other.m_resize_strategy);
+        m_allocator      = std::move(other.m_allocator);
         m_overflow       = std::move(other.m_overflow);
+        m_rehash_source  = std::move(other.m_rehash_source);
+        m_rehash_cursor  = std::move(other.m_rehash_cursor);
+        m_rehash_step    = std::move(other.m_rehash_step);
+        m_min_load_factor = std::move(other.m_min_load_factor);
+        m_growth         = std::move(other.m_growth);
+        m_instrumentation = std::move(other.m_instrumentation);
         ON_DEBUG(m_plainkeys = std::move(other.m_plainkeys); other.m_plainkeys = nullptr;)
         other.m_bucketsizes = nullptr; //! a hash map without buckets is already deleted
+        other.m_rehash_source = nullptr;
         return *this;
     }
     void swap(separate_chaining_table& other) {
@@ -373,7 +493,14 @@ class separate_chaining_table {
         std::swap(m_hash, other.m_hash);
         std::swap(m_elements, other.m_elements);
         std::swap(m_resize_strategy, other.m_resize_strategy);
+        std::swap(m_allocator, other.m_allocator);
         std::swap(m_overflow, other.m_overflow);
+        std::swap(m_rehash_source, other.m_rehash_source);
+        std::swap(m_rehash_cursor, other.m_rehash_cursor);
+        std::swap(m_rehash_step, other.m_rehash_step);
+        std::swap(m_min_load_factor, other.m_min_load_factor);
+        std::swap(m_growth, other.m_growth);
+        std::swap(m_instrumentation, other.m_instrumentation);
     }
 
 #if STATS_ENABLED && PRINT_STATS
@@ -412,8 +539,246 @@ class separate_chaining_table {
 #endif
 
 
+    /**
+     * Enables incremental rehashing if `buckets_per_operation` > 0.
+     * When the table needs to grow, it then keeps its old buckets alongside the new ones and migrates
+     * `buckets_per_operation` non-empty old buckets on each subsequent insertion or erasure,
+     * instead of rehashing all elements at once. An operation visits at most `REHASH_VISITS_PER_STEP * buckets_per_operation` old buckets,
+     * such that it migrates fewer buckets if the old table is sparse.
+     * Lookups consult the old buckets not yet migrated.
+     * Setting it to 0 (the default) finishes a pending rehash and disables incremental rehashing.
+     */
+    void incremental_rehash(const size_t buckets_per_operation) {
+        m_rehash_step = buckets_per_operation;
+        if(m_rehash_step == 0) finish_rehash();
+    }
+    size_t incremental_rehash() const { return m_rehash_step; }
+
+    //! whether an incremental rehash has not yet migrated all old buckets
+    bool rehash_pending() const { return m_rehash_source != nullptr; }
+
+    //! @see std::unordered_map
+    float load_factor() const {
+        if(m_buckets == 0) return 0;
+        return static_cast<float>(m_elements) / bucket_count();
+    }
+
+    /**
+     * Lets the table shrink automatically: once an erasure lets `load_factor()` drop below `min_load_factor`, the number of buckets is halved by `merge_buckets`.
+     * Since a table only grows when a bucket exceeds `bucket_cap()` elements or when `load_factor()` exceeds the maximum of its `growth_policy`,
+     * a value well below half of both keeps the table from alternately growing and shrinking. The table does not shrink below `INITIAL_BUCKETS` buckets this way.
+     * Setting it to 0 (the default) disables shrinking. If the table is already sparser, it shrinks immediately.
+     */
+    void min_load_factor(const float min_load_factor) {
+        m_min_load_factor = min_load_factor;
+        while(m_buckets > 0 && bucket_count() > separate_chaining::INITIAL_BUCKETS && load_factor() < m_min_load_factor && merge_buckets()) {}
+    }
+    float min_load_factor() const { return m_min_load_factor; }
+
+    /**
+     * Sets the number of buckets to the smallest power of two that is at least `buckets`.
+     * Growing is done by `reserve`. Shrinking halves the number of buckets with `merge_buckets` until reaching this number,
+     * or until merging would let a bucket exceed `bucket_cap()` elements.
+     */
+    void rehash(const size_t buckets) {
+        if(m_buckets == 0 && buckets == 0) return;
+        if(m_buckets == 0 || buckets > bucket_count()) {
+            reserve(buckets);
+            return;
+        }
+        const uint_fast8_t target_buckets = std::max<uint_fast8_t>(1, ceil_log2(buckets));
+        while(m_buckets > target_buckets && merge_buckets()) {}
+    }
+
+    /**
+     * Halves the number of buckets by merging each bucket `b` with the bucket `b + bucket_count()/2` into the bucket `b`.
+     * The new quotients are computed from the old ones by the hash mapping's `merge`, such that no key is hashed again.
+     * The merged buckets are allocated with their exact sizes, and the old buckets are freed one after another.
+     * Returns false without changing the table if a merged bucket would exceed `bucket_cap()`,
+     * or if its quotients would not fit into `storage_type`.
+     */
+    bool merge_buckets() {
+        finish_rehash();
+        if(m_buckets <= 1) return false;
+        if(m_hash.remainder_width(m_buckets-1) > sizeof(storage_type)*8) return false;
+        const size_t half = bucket_count()/2;
+        for(size_t bucket = 0; bucket < half; ++bucket) {
+            if(static_cast<size_t>(m_bucketsizes[bucket]) + m_bucketsizes[bucket+half] > bucket_cap()) return false;
+        }
+
+        separate_chaining_table target(m_key_width, m_value_width);
+        target.reserve(half);
+        DDCHECK_EQ(target.m_buckets+1, m_buckets);
+        const uint_fast8_t quotient_width = m_hash.remainder_width(m_buckets);
+        const uint_fast8_t target_quotient_width = target.m_hash.remainder_width(target.m_buckets);
+        for(size_t bucket = 0; bucket < half; ++bucket) {
+            const bucketsize_type target_size = m_bucketsizes[bucket] + m_bucketsizes[bucket+half];
+            if(target_size == 0) continue;
+            target.initialize_bucket(bucket, target_size);
+            bucketsize_type position = 0;
+            for(const size_t source_bucket : { bucket, bucket+half }) {
+                const bucketsize_type source_size = m_bucketsizes[source_bucket];
+                if(source_size == 0) continue;
+                for(size_t i = 0; i < source_size; ++i, ++position) {
+                    const auto [quotient, new_bucket] = m_hash.merge(m_keys[source_bucket].read(i, quotient_width), source_bucket, m_buckets);
+                    DDCHECK_EQ(new_bucket, bucket);
+                    target.m_keys[bucket].write(position, quotient, target_quotient_width);
+                    target.m_value_manager[bucket].write(position, m_value_manager[source_bucket].read(i, value_width()), value_width());
+                    ON_DEBUG(target.m_plainkeys[bucket][position] = m_plainkeys[source_bucket][i];)
+                    DDCHECK_EQ(target.m_hash.inv_map(quotient, bucket, target.m_buckets), target.m_plainkeys[bucket][position]);
+                }
+                clear(source_bucket);
+            }
+            target.m_elements += target_size;
+        }
+        {
+            size_t i = m_overflow.first_position();
+            while(m_overflow.valid_position(i)) {
+                target.find_or_insert(m_overflow.key(i), std::move(m_overflow[i]));
+                i = m_overflow.next_position(i);
+            }
+        }
+        DDCHECK_EQ(m_elements, target.m_elements);
+        target.m_rehash_step = m_rehash_step;
+        target.m_min_load_factor = m_min_load_factor;
+        target.m_growth = m_growth;
+        target.m_instrumentation = m_instrumentation;
+        clear_structure();
+        swap(target);
+        return true;
+    }
+
+    //! migrates all remaining old buckets of a pending incremental rehash
+    void finish_rehash() {
+        if(m_rehash_source == nullptr) return;
+        for(; m_rehash_cursor < m_rehash_source->bucket_count(); ++m_rehash_cursor) {
+            migrate_bucket(m_rehash_cursor);
+        }
+        end_rehash();
+    }
+
+    private:
+    /**
+     * Doubles the number of buckets: the current buckets become the source of a rehash, and each bucket `b` of the source
+     * is later split into the buckets `b` and `b + bucket_count()/2` by `migrate_bucket`.
+     */
+    void start_rehash() {
+        DDCHECK(m_rehash_source == nullptr);
+        const size_t new_size = 1ULL<<(m_buckets+1);
+        separate_chaining_table* source = new separate_chaining_table(m_key_width, m_value_width);
+        source->swap(*this);
+        std::swap(m_rehash_step, source->m_rehash_step);
+        std::swap(m_min_load_factor, source->m_min_load_factor);
+        std::swap(m_growth, source->m_growth);
+        std::swap(m_instrumentation, source->m_instrumentation);
+        reserve(new_size);
+        m_rehash_source = source;
+        m_rehash_cursor = 0;
+        m_elements = source->m_elements;
+    }
+
+    //! deletes the source after all its buckets are migrated, and re-inserts the elements of its overflow table
+    void end_rehash() {
+        separate_chaining_table* source = m_rehash_source;
+        m_rehash_source = nullptr;
+        m_rehash_cursor = 0;
+        DDCHECK_EQ(source->m_elements, source->m_overflow.size());
+        m_elements -= source->m_overflow.size();
+        size_t i = source->m_overflow.first_position();
+        while(source->m_overflow.valid_position(i)) {
+            find_or_insert(source->m_overflow.key(i), std::move(source->m_overflow[i]));
+            i = source->m_overflow.next_position(i);
+        }
+        delete source;
+    }
+
+    /**
+     * Splits bucket `bucket` of `m_rehash_source` into the buckets `bucket` and `bucket + m_rehash_source->bucket_count()` of this table.
+     * The new quotients are computed from the old ones by the hash mapping's `split`, and both buckets are allocated with their exact sizes.
+     * The source bucket is freed afterwards.
+     */
+    void migrate_bucket(const size_t bucket) {
+        separate_chaining_table& source = *m_rehash_source;
+        const bucketsize_type bucket_size = source.m_bucketsizes[bucket];
+        if(bucket_size == 0) return;
+        DDCHECK_EQ(source.m_buckets+1, m_buckets);
+        const key_bucket_type& source_keys = source.m_keys[bucket];
+        const value_bucket_type& source_values = source.m_value_manager[bucket];
+        const uint_fast8_t source_quotient_width = source.m_hash.remainder_width(source.m_buckets);
+        const uint_fast8_t quotient_width = m_hash.remainder_width(m_buckets);
+        const size_t high_bucket = bucket + source.bucket_count();
+
+        storage_type quotients[max_bucket_size()];
+        bool is_high[max_bucket_size()];
+        bucketsize_type high_size = 0;
+        for(size_t i = 0; i < bucket_size; ++i) {
+            const auto [quotient, new_bucket] = m_hash.split(source_keys.read(i, source_quotient_width), bucket, source.m_buckets);
+            DDCHECK(new_bucket == bucket || new_bucket == high_bucket);
+            quotients[i] = quotient;
+            is_high[i] = new_bucket == high_bucket;
+            high_size += is_high[i];
+        }
+        const bucketsize_type low_size = bucket_size - high_size;
+        DDCHECK_EQ(m_bucketsizes[bucket], 0);
+        DDCHECK_EQ(m_bucketsizes[high_bucket], 0);
+        if(low_size > 0) { initialize_bucket(bucket, low_size); }
+        if(high_size > 0) { initialize_bucket(high_bucket, high_size); }
+
+        bucketsize_type positions[2] = { 0, 0 };
+        for(size_t i = 0; i < bucket_size; ++i) {
+            const size_t new_bucket = is_high[i] ? high_bucket : bucket;
+            const bucketsize_type position = positions[is_high[i]]++;
+            m_keys[new_bucket].write(position, quotients[i], quotient_width);
+            m_value_manager[new_bucket].write(position, source_values.read(i, value_width()), value_width());
+            ON_DEBUG(m_plainkeys[new_bucket][position] = source.m_plainkeys[bucket][i];)
+            DDCHECK_EQ(m_hash.inv_map(quotients[i], new_bucket, m_buckets), m_plainkeys[new_bucket][position]);
+        }
+        source.m_elements -= bucket_size;
+        source.clear(bucket);
+    }
+
+    //! allocates exactly `size` elements for the empty bucket `bucket`, which becomes full
+    void initialize_bucket(const size_t bucket, const bucketsize_type size) {
+        m_bucketsizes[bucket] = size;
+        m_keys[bucket].initialize(size, m_hash.remainder_width(m_buckets), m_allocator);
+        m_value_manager[bucket].initialize(size, value_width(), m_allocator);
+        m_resize_strategy.assign(size, bucket);
+        ON_DEBUG(m_plainkeys[bucket] = reinterpret_cast<key_type*>(malloc(sizeof(key_type)*size));)
+    }
+
+    //! doubles the number of buckets, incrementally if enabled by `incremental_rehash`
+    void grow() {
+        if(m_rehash_step > 0 && m_overflow.size() == 0) { // the source's overflow table is not consulted while the rehash is pending
+            const typename instrumentation_type::rehash_timer timer(m_instrumentation);
+            start_rehash();
+        } else {
+            reserve(1ULL<<(m_buckets+1));
+        }
+    }
+
+    /**
+     * migrates the next `m_rehash_step` non-empty buckets of a pending incremental rehash,
+     * visiting at most `REHASH_VISITS_PER_STEP * m_rehash_step` old buckets, such that a sparse old table does not make a single step scan all its buckets
+     */
+    void rehash_step() {
+        if(m_rehash_source == nullptr) return;
+        const size_t source_bucket_count = m_rehash_source->bucket_count();
+        const size_t end = std::min(source_bucket_count, m_rehash_cursor + REHASH_VISITS_PER_STEP * m_rehash_step);
+        for(size_t migrated = 0; migrated < m_rehash_step && m_rehash_cursor < end; ++m_rehash_cursor) {
+            if(m_rehash_source->m_bucketsizes[m_rehash_cursor] == 0) continue;
+            migrate_bucket(m_rehash_cursor);
+            ++migrated;
+        }
+        if(m_rehash_cursor == source_bucket_count) {
+            end_rehash();
+        }
+    }
+
+    public:
+
     //! Allocate `reserve` buckets. Do not confuse with reserving space for `reserve` elements.
     void reserve(size_t reserve) {
+        finish_rehash();
         uint_fast8_t reserve_bits = most_significant_bit(reserve);
         if(1ULL<<reserve_bits != reserve) ++reserve_bits;
         const size_t new_size = 1ULL<<reserve_bits;
@@ -429,7 +794,12 @@ class separate_chaining_table {
             std::fill(m_bucketsizes, m_bucketsizes+new_size, 0);
             m_buckets = reserve_bits;
             m_overflow.resize_buckets(new_size, key_width(), value_width());
+        } else if(reserve_bits == m_buckets+1) { // split each bucket into its two successors
+            const typename instrumentation_type::rehash_timer timer(m_instrumentation);
+            start_rehash();
+            finish_rehash();
         } else {
+            const typename instrumentation_type::rehash_timer timer(m_instrumentation);
             separate_chaining_table tmp_map(m_key_width, m_value_width);
             tmp_map.reserve(new_size);
 #if STATS_ENABLED && PRINT_STATS
@@ -462,17 +832,123 @@ class separate_chaining_table {
             }
 
             DDCHECK_EQ(m_elements, tmp_map.m_elements);
+            tmp_map.m_rehash_step = m_rehash_step;
+            tmp_map.m_min_load_factor = m_min_load_factor;
+            tmp_map.m_growth = m_growth;
+            tmp_map.m_instrumentation = m_instrumentation;
             clear_structure();
             swap(tmp_map);
         }
     }
+
+    /**
+     * Replaces the content of the hash table by the keys of [`keys_first`, `keys_last`) and their values starting at `values_first`.
+     * Unlike inserting the elements one by one, this allocates each bucket exactly once:
+     * A first pass counts the elements per bucket to choose a number of buckets for which no bucket exceeds `bucket_cap()`,
+     * and a second pass scatters the elements into their buckets.
+     * If a key occurs multiple times, its first occurrence wins, as with `find_or_insert`.
+     * Both ranges are traversed multiple times, so forward iterators are required.
+     */
+    template<class key_iterator, class value_iterator>
+    void build(const key_iterator keys_first, const key_iterator keys_last, const value_iterator values_first) {
+        clear();
+        const size_t length = std::distance(keys_first, keys_last);
+        if(length == 0) return;
+
+        //! aim at half-full buckets on average, but use at least as many buckets as `find_or_insert` starts with
+        const uint_fast8_t max_buckets = key_width()-1;
+        uint_fast8_t buckets = std::min<uint_fast8_t>(max_buckets, std::max<uint_fast8_t>(
+                    ceil_log2(std::min<size_t>(key_width()-1, separate_chaining::INITIAL_BUCKETS)),
+                    ceil_log2(ceil_div<size_t>(length, std::max<size_t>(1, bucket_cap()/2)))));
+        if(m_growth.max_load_factor > 0) { //! respect the maximum load factor of the growth policy
+            buckets = std::min<uint_fast8_t>(max_buckets, std::max<uint_fast8_t>(buckets, ceil_log2(std::ceil(length / m_growth.max_load_factor))));
+        }
+        size_t* bucket_capacities = nullptr;
+        for(size_t attempt = 0; ; ++attempt) {
+            bucket_capacities = reinterpret_cast<size_t*>(realloc(bucket_capacities, sizeof(size_t)<<buckets));
+            std::fill(bucket_capacities, bucket_capacities + (1ULL<<buckets), 0);
+            size_t largest_bucket = 0;
+            for(auto key_it = keys_first; key_it != keys_last; ++key_it) {
+                largest_bucket = std::max(largest_bucket, ++bucket_capacities[m_hash.map(*key_it, buckets).second]);
+            }
+            //! a bucket can still be too large due to duplicate keys, whose excess is inserted afterwards with `find_or_insert`
+            if(largest_bucket <= bucket_cap() || buckets == max_buckets || attempt == BUILD_MAX_ATTEMPTS) { break; }
+            ++buckets;
+        }
+
+        reserve(1ULL<<buckets);
+        DDCHECK_EQ(m_buckets, buckets);
+        const size_t cbucket_count = bucket_count();
+        const uint_fast8_t quotient_width = m_hash.remainder_width(m_buckets);
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            size_t& capacity = bucket_capacities[bucket];
+            if(capacity == 0) continue;
+            capacity = std::min<size_t>(capacity, bucket_cap());
+            m_keys[bucket].initialize(capacity, quotient_width, m_allocator);
+            m_value_manager[bucket].initialize(capacity, value_width(), m_allocator);
+            m_resize_strategy.assign(capacity, bucket);
+            ON_DEBUG(m_plainkeys[bucket] = reinterpret_cast<key_type*>(malloc(sizeof(key_type)*capacity));)
+        }
+
+        bool has_excess = false;
+        value_iterator value_it = values_first;
+        for(auto key_it = keys_first; key_it != keys_last; ++key_it, ++value_it) {
+            const key_type key = *key_it;
+            const auto [quotient, bucket] = m_hash.map(key, m_buckets);
+            bucketsize_type& bucket_size = m_bucketsizes[bucket];
+            if(m_keys[bucket].find(quotient, bucket_size, quotient_width) != static_cast<size_t>(-1ULL)) { continue; }
+            if(bucket_size == bucket_capacities[bucket]) {
+                has_excess = true;
+                continue;
+            }
+            m_keys[bucket].write(bucket_size, quotient, quotient_width);
+            m_value_manager[bucket].write(bucket_size, static_cast<value_type>(*value_it), value_width());
+            ON_DEBUG(m_plainkeys[bucket][bucket_size] = key;)
+            ++bucket_size;
+            ++m_elements;
+        }
+
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) { //! buckets with duplicate keys are not full
+            if(m_bucketsizes[bucket] < bucket_capacities[bucket]) { shrink_to_fit(bucket); }
+        }
+        free(bucket_capacities);
+
+        if(has_excess) {
+            value_it = values_first;
+            for(auto key_it = keys_first; key_it != keys_last; ++key_it, ++value_it) {
+                find_or_insert(*key_it, static_cast<value_type>(*value_it));
+            }
+        }
+    }
+
+    //! bulk-loads a hash set. @see build(keys_first, keys_last, values_first)
+    template<class key_iterator>
+    void build(const key_iterator keys_first, const key_iterator keys_last) {
+        build(keys_first, keys_last, default_value_iterator());
+    }
+
+    private:
+    static constexpr size_t BUILD_MAX_ATTEMPTS = 4; //! number of times `build` doubles the number of buckets before falling back to `find_or_insert` for overfull buckets
+
+    //! yields default-constructed values, used for building hash sets
+    struct default_value_iterator {
+        value_type operator*() const { return value_type(); }
+        default_value_iterator& operator++() { return *this; }
+    };
+
+    //! returns the smallest `k` with 2^`k` >= `x`
+    static constexpr uint_fast8_t ceil_log2(const size_t x) {
+        return x <= 1 ? 0 : bit_width(x-1);
+    }
+
+    public:
     const navigator rbegin_nav() {
         const size_t cbucket_count = bucket_count();
         if(m_overflow.size() > 0) return { *this, cbucket_count, m_overflow.size() };
         if(cbucket_count == 0) return end_nav();
         for(size_t bucket = cbucket_count-1; bucket >= 0;  --bucket) {
-            if(m_bucketsizes[bucket] > 0) {
-                return { *this, bucket, static_cast<size_t>(m_bucketsizes[bucket]-1) };
+            if(bucket_size(bucket) > 0) {
+                return { *this, bucket, static_cast<size_t>(bucket_size(bucket)-1) };
             }
         }
         return end_nav();
@@ -488,7 +964,7 @@ class separate_chaining_table {
     const iterator begin() {
         const size_t cbucket_count = bucket_count();
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
-            if(m_bucketsizes[bucket] > 0) {
+            if(bucket_size(bucket) > 0) {
                 return { *this, bucket, 0 };
             }
         }
@@ -498,7 +974,7 @@ class separate_chaining_table {
     const const_iterator cbegin() const {
         const size_t cbucket_count = bucket_count();
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
-            if(m_bucketsizes[bucket] > 0) {
+            if(bucket_size(bucket) > 0) {
                 return { *this, bucket, 0 };
             }
         }
@@ -508,7 +984,7 @@ class separate_chaining_table {
     const navigator begin_nav() {
         const size_t cbucket_count = bucket_count();
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
-            if(m_bucketsizes[bucket] > 0) {
+            if(bucket_size(bucket) > 0) {
                 return { *this, bucket, 0 };
             }
         }
@@ -521,7 +997,7 @@ class separate_chaining_table {
     const const_navigator cbegin_nav() const {
         const size_t cbucket_count = bucket_count();
         for(size_t bucket = 0; bucket < cbucket_count;  ++bucket) {
-            if(m_bucketsizes[bucket] > 0) {
+            if(bucket_size(bucket) > 0) {
                 return { *this, bucket, 0 };
             }
         }
@@ -532,35 +1008,72 @@ class separate_chaining_table {
         return { *this, -1ULL, -1ULL };
     }
 
+    /**
+     * A key together with its quotient and its bucket in a table with `2^generation` buckets.
+     * Obtained by `hash(key)`, it lets `find` and `find_or_insert` skip hashing the key,
+     * and can be reused for other tables with the same hash mapping and the same number of buckets.
+     */
+    struct hashed_key {
+        key_type key;
+        storage_type quotient;
+        size_t bucket;
+        uint_fast8_t generation; //! `bucket_count_log2()` of the table at the time of hashing
+    };
+
+    //! computes the location of `key` in this table, valid until the number of buckets changes
+    hashed_key hash(const key_type& key) const {
+        if(m_buckets == 0) { return { key, 0, 0, 0 }; }
+        const auto [quotient, bucket] = m_hash.map(key, m_buckets);
+        DDCHECK_EQ(m_hash.inv_map(quotient, bucket, m_buckets), key);
+        return { key, quotient, bucket, m_buckets };
+    }
+
     const_iterator find(const key_type& key) const {
+        return find(hash(key));
+    }
+
+    /**
+     * Like `find(key)` for the key of `hashed`, but without hashing the key again.
+     * `hashed` has to be obtained by `hash` after the last change of the number of buckets.
+     */
+    const_iterator find(const hashed_key& hashed) const {
+        DDCHECK_EQ(hashed.generation, m_buckets);
         if(m_buckets == 0) return cend();
+        const key_type& key = hashed.key;
+        if(hashed.generation != m_buckets) { return find(key); } // the table has been resized since hashing
         if(m_overflow.size() > 0) {
             const size_t position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(position != static_cast<size_t>(-1ULL));
             if(position != static_cast<size_t>(-1ULL)) {
                 return const_iterator { *this, bucket_count(), position };
             }
         }
-        const auto [quotient, bucket] = m_hash.map(key, m_buckets);
-        DDCHECK_EQ(m_hash.inv_map(quotient, bucket, m_buckets), key);
-        const size_t position = locate(bucket, quotient);
+        if(m_rehash_source != nullptr) {
+            const auto [source_bucket, source_position] = locate_in_source(key);
+            if(source_bucket != static_cast<size_t>(-1ULL)) {
+                if(source_position == static_cast<size_t>(-1ULL)) { return cend(); }
+                return const_iterator { *this, source_bucket, source_position };
+            }
+        }
+        const size_t position = locate(hashed.bucket, hashed.quotient);
         if(position == static_cast<size_t>(-1ULL)) {
             return cend();
         }
-        return const_iterator { *this, bucket, position };
+        return const_iterator { *this, hashed.bucket, position };
     }
 
-    private:
+    //! returns the position of the key with quotient `quotient` in `bucket`, or -1 if it is not stored there
     size_t locate(const size_t& bucket, const storage_type& quotient) const {
         const uint_fast8_t key_bitwidth = m_hash.remainder_width(m_buckets);
         DDCHECK_GT(key_bitwidth, 0);
         DDCHECK_LE(key_bitwidth, key_width());
         DDCHECK_LE(most_significant_bit(quotient), key_bitwidth);
 
-        bucketsize_type& bucket_size = m_bucketsizes[bucket];
-        key_bucket_type& bucket_keys = m_keys[bucket];
+        const bucketsize_type& bucket_size = m_bucketsizes[bucket];
+        const key_bucket_type& bucket_keys = m_keys[bucket];
 
 #ifndef NDEBUG
-        key_type*& bucket_plainkeys = m_plainkeys[bucket];
+        const key_type* bucket_plainkeys = m_plainkeys[bucket];
         size_t plain_position = static_cast<size_t>(-1ULL);
         for(size_t i = 0; i < bucket_size; ++i) { 
             const key_type read_quotient = bucket_keys.read(i, key_bitwidth);
@@ -574,6 +1087,7 @@ class separate_chaining_table {
 #endif//NDEBUG
         
         const size_t position = bucket_keys.find(quotient, bucket_size, key_bitwidth);
+        m_instrumentation.locate(position == static_cast<size_t>(-1ULL) ? bucket_size : position+1, position != static_cast<size_t>(-1ULL));
 
 #ifndef NDEBUG
         DDCHECK_EQ(position, plain_position);
@@ -585,6 +1099,21 @@ class separate_chaining_table {
         return position;
     }
 
+    private:
+    /**
+     * helper for a pending incremental rehash:
+     * if the bucket of `key` has not been migrated yet, returns this bucket and the position of `key` in it (-1 if `key` is not stored).
+     * Otherwise returns (-1,-1).
+     */
+    std::pair<size_t, size_t> locate_in_source(const key_type& key) const {
+        DDCHECK(m_rehash_source != nullptr);
+        const auto [quotient, bucket] = m_hash.map(key, m_rehash_source->m_buckets);
+        if(m_rehash_source->m_bucketsizes[bucket] == 0) {
+            return { static_cast<size_t>(-1ULL), static_cast<size_t>(-1ULL) };
+        }
+        return { bucket, m_rehash_source->locate(bucket, quotient) };
+    }
+
     public:
     /*
      * Returns the location of a key if it is stored in the table.
@@ -599,55 +1128,239 @@ class separate_chaining_table {
 
 		if(m_overflow.need_consult(bucket) && m_overflow.size() > 0) { 
             const size_t position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(position != (-1ULL));
             if(position != (-1ULL)) {
                 return { bucket_count(), position };
             }
         }
+        if(m_rehash_source != nullptr) {
+            const auto source_location = locate_in_source(key);
+            if(source_location.first != static_cast<size_t>(-1ULL)) { return source_location; }
+        }
 
         return { bucket, locate(bucket, quotient) };
     }
 
-    navigator find_or_insert(const key_type& key, value_type&& value) {
+    /**
+     * Looks up `n` keys at once. Writes the location of `keys[i]` into `locations[i]` with the same semantics as `locate(key)`,
+     * except that an empty table yields the location (0,-1) instead of throwing.
+     * Returns the number of keys that are stored in the table.
+     * The keys are processed in windows of `BATCH_WINDOW` keys such that the cache misses on the bucket sizes,
+     * the bucket headers and the bucket contents of a window overlap.
+     */
+    size_type find_batch(const key_type* keys, const size_t n, std::pair<size_t, size_t>* locations) const {
+        return resolve_batch(keys, n, [locations] (const size_t i, const size_t bucket, const size_t position) {
+                locations[i] = { bucket, position };
+                });
+    }
+
+    //! returns the number of keys of `keys[0..n-1]` stored in the table, i.e., the sum of `count(keys[i])`. @see find_batch
+    size_type count_batch(const key_type* keys, const size_t n) const {
+        return resolve_batch(keys, n, [] (const size_t, const size_t, const size_t) {});
+    }
+
+    private:
+    static constexpr size_t BATCH_WINDOW = 16; //! number of keys whose memory accesses are issued ahead of their resolution in `find_batch`
+
+    /**
+     * helper for `find_batch` and `count_batch`:
+     * first hashes a window of keys and prefetches the bucket sizes and the key/value bucket headers,
+     * then prefetches the contents of the key and value buckets, and finally locates each key.
+     * Calls `callback(i, bucket, position)` for each key `keys[i]`.
+     */
+    template<class callback_type>
+    size_type resolve_batch(const key_type* keys, const size_t n, callback_type&& callback) const {
+        if(m_buckets == 0) {
+            for(size_t i = 0; i < n; ++i) { callback(i, 0, static_cast<size_t>(-1ULL)); }
+            return 0;
+        }
+        if(m_rehash_source != nullptr) { // keys may reside in two different tables
+            size_type found = 0;
+            for(size_t i = 0; i < n; ++i) {
+                const auto [bucket, position] = locate(keys[i]);
+                if(position != static_cast<size_t>(-1ULL)) { ++found; }
+                callback(i, bucket, position);
+            }
+            return found;
+        }
+        storage_type quotients[BATCH_WINDOW];
+        size_t buckets[BATCH_WINDOW];
+        size_type found = 0;
+
+        for(size_t offset = 0; offset < n; offset += BATCH_WINDOW) {
+            const size_t window = std::min<size_t>(BATCH_WINDOW, n-offset);
+            for(size_t i = 0; i < window; ++i) {
+                const auto [quotient, bucket] = m_hash.map(keys[offset+i], m_buckets);
+                DDCHECK_EQ(m_hash.inv_map(quotient, bucket, m_buckets), keys[offset+i]);
+                quotients[i] = quotient;
+                buckets[i] = bucket;
+                __builtin_prefetch(m_bucketsizes + bucket);
+                __builtin_prefetch(m_keys + bucket);
+                __builtin_prefetch(&m_value_manager[bucket]);
+            }
+            for(size_t i = 0; i < window; ++i) {
+                m_keys[buckets[i]].prefetch();
+                m_value_manager[buckets[i]].prefetch();
+            }
+            for(size_t i = 0; i < window; ++i) {
+                const size_t& bucket = buckets[i];
+                if(m_overflow.size() > 0 && m_overflow.need_consult(bucket)) {
+                    const size_t position = m_overflow.find(keys[offset+i]);
+                    m_instrumentation.overflow_consult(position != static_cast<size_t>(-1ULL));
+                    if(position != static_cast<size_t>(-1ULL)) {
+                        ++found;
+                        callback(offset+i, bucket_count(), position);
+                        continue;
+                    }
+                }
+                const size_t position = locate(bucket, quotients[i]);
+                if(position != static_cast<size_t>(-1ULL)) { ++found; }
+                callback(offset+i, bucket, position);
+            }
+        }
+        return found;
+    }
+
+    private:
+    /**
+     * Core of the insertion operations: looks up the key of `hashed` with a single `locate`, and inserts it with the value `make_value()` if it is not stored.
+     * `make_value` is called at most once, and only if the key is inserted. The key is hashed again only if the number of buckets differs from the one of `hashed`.
+     * Returns a navigator to the element of the key and whether the key has been inserted.
+     */
+    template<class value_factory>
+    std::pair<navigator, bool> emplace_with(const hashed_key& hashed, value_factory&& make_value) {
+        std::optional<value_type> value; //! kept across the retries after a failed insertion into the overflow table and growing
+        const auto materialize = [&value, &make_value] () -> value_type& {
+            if(!value) { value.emplace(make_value()); }
+            return *value;
+        };
+        return emplace_materialized(hashed, materialize);
+    }
+
+    //! `emplace_with` with the value `materialize()`, which constructs the value on its first call and returns the same object on later calls
+    template<class value_materializer>
+    std::pair<navigator, bool> emplace_materialized(const hashed_key& hashed, const value_materializer& materialize) {
+        const key_type& key = hashed.key;
         DDCHECK_GT(key_width(), 1);
         if(m_buckets == 0) reserve(std::min<size_t>(key_width()-1, separate_chaining::INITIAL_BUCKETS));
-        const auto [quotient, bucket] = m_hash.map(key, m_buckets);
+        rehash_step();
+        if(m_rehash_source != nullptr) {
+            separate_chaining_table& source = *m_rehash_source;
+            const auto [source_quotient, source_bucket] = m_hash.map(key, source.m_buckets);
+            if(source.m_bucketsizes[source_bucket] > 0) { // key belongs to a bucket not yet migrated
+                const size_t source_position = source.locate(source_bucket, source_quotient);
+                if(source_position != static_cast<size_t>(-1ULL)) {
+                    return { navigator { *this, source_bucket, source_position }, false };
+                }
+                if(source.m_bucketsizes[source_bucket] < bucket_cap()) {
+                    ++m_elements;
+                    ++source.m_elements;
+                    return { navigator { *this, source_bucket, source.append(source_bucket, source_quotient, key, std::move(materialize())) }, true };
+                }
+                migrate_bucket(source_bucket);
+            }
+        }
+        const auto [quotient, bucket] = hashed.generation == m_buckets ? std::make_pair(hashed.quotient, hashed.bucket) : m_hash.map(key, m_buckets);
         DDCHECK_EQ(m_hash.inv_map(quotient, bucket, m_buckets), key);
 
         bucketsize_type& bucket_size = m_bucketsizes[bucket];
         const size_t position = locate(bucket, quotient);
 
-        value_bucket_type& bucket_values = m_value_manager[bucket];
         if(position != static_cast<size_t>(-1ULL)) {
             DDCHECK_LT(position, bucket_size);
-            return { *this, bucket, position };
+            return { navigator { *this, bucket, position }, false };
         }
         if(m_overflow.need_consult(bucket)) {
             const size_t overflow_position = m_overflow.find(key);
+            m_instrumentation.overflow_consult(overflow_position != static_cast<size_t>(-1ULL));
             if(overflow_position != static_cast<size_t>(-1ULL)) {
-                return { *this, bucket_count(), overflow_position };
+                return { navigator { *this, bucket_count(), overflow_position }, false };
             }
         }
 
 
-        if(bucket_size == max_bucket_size()) {
+        if(bucket_size >= bucket_cap()) {
+            if(m_rehash_source != nullptr) { // the table is already growing
+                finish_rehash();
+                return emplace_materialized(hashed, materialize);
+            }
             if(m_overflow.size() < m_overflow.capacity()) {
-                const size_t overflow_position = m_overflow.insert(bucket, key, std::move(value));
+                const size_t overflow_position = m_overflow.insert(bucket, key, materialize());
                 if(overflow_position != static_cast<size_t>(-1ULL)) { // could successfully insert element into overflow table
                     ++m_elements;
                     DDCHECK_EQ(m_overflow.find(key), overflow_position);
-                    DDCHECK_EQ(m_overflow[m_overflow.find(key)], value);
-                    return { *this, bucket_count(), overflow_position };
+                    return { navigator { *this, bucket_count(), overflow_position }, true };
                 }
             }
             // if(m_elements*separate_chaining::FAIL_PERCENTAGE < max_size()) {
             //     throw std::runtime_error("The chosen hash function is bad!");
             // }
-            reserve(1ULL<<(m_buckets+1));
-            return find_or_insert(key, std::move(value));
+            const bool hot = load_factor() < m_growth.hot_load_factor;
+            if(!hot || bucket_size == max_bucket_size()) {
+                grow();
+                return emplace_materialized(hashed, materialize);
+            }
+        } else if(m_growth.max_load_factor > 0 && m_rehash_source == nullptr && m_elements+1 > m_growth.max_load_factor * bucket_count() && m_buckets+1 < key_width()) {
+            grow();
+            return emplace_materialized(hashed, materialize);
         }
         ++m_elements;
+        return { navigator { *this, bucket, append(bucket, quotient, key, std::move(materialize())) }, true };
+    }
+
+    public:
+    navigator find_or_insert(const key_type& key, value_type&& value) {
+        return emplace_with(hash(key), [&value] () -> value_type&& { return std::move(value); }).first;
+    }
+
+    /**
+     * Like `find_or_insert(key, value)` for the key of `hashed`, but without hashing the key again.
+     * `hashed` has to be obtained by `hash` after the last change of the number of buckets.
+     */
+    navigator find_or_insert(const hashed_key& hashed, value_type&& value) {
+        DDCHECK_EQ(hashed.generation, m_buckets);
+        return emplace_with(hashed, [&value] () -> value_type&& { return std::move(value); }).first;
+    }
+
+    /**
+     * Inserts `key` with a value constructed from `args` if `key` is not stored; the value is only constructed on insertion.
+     * Returns a navigator to the element of `key` and whether `key` has been inserted. @see std::unordered_map::try_emplace
+     */
+    template<class... Args>
+    std::pair<navigator, bool> try_emplace(const key_type& key, Args&&... args) {
+        return emplace_with(hash(key), [&args...] () { return value_type(std::forward<Args>(args)...); });
+    }
+
+    /**
+     * Stores `value` with `key`, overwriting a possibly stored value.
+     * Returns a navigator to the element of `key` and whether `key` has been inserted. @see std::unordered_map::insert_or_assign
+     */
+    std::pair<navigator, bool> insert_or_assign(const key_type& key, const value_type& value) {
+        auto result = emplace_with(hash(key), [&value] () { return value; });
+        if(!result.second) { result.first = value; }
+        return result;
+    }
 
+    /**
+     * Inserts `key` with `value` if `key` is not stored.
+     * Otherwise, replaces the stored value `v` with `merge(v, value)`, e.g., `std::plus` for counting.
+     * Returns a navigator to the element of `key` and whether `key` has been inserted.
+     */
+    template<class merge_function>
+    std::pair<navigator, bool> upsert(const key_type& key, const value_type& value, merge_function&& merge) {
+        auto result = emplace_with(hash(key), [&value] () { return value; });
+        if(!result.second) { result.first = merge(result.first.value(), value); }
+        return result;
+    }
+
+
+    private:
+    //! appends a key, given by its quotient, and its value to `bucket`, and returns its position. Does not update `m_elements`.
+    size_t append(const size_t bucket, const storage_type& quotient, [[maybe_unused]] const key_type& key, value_type&& value) {
+        bucketsize_type& bucket_size = m_bucketsizes[bucket];
+        DDCHECK_LT(bucket_size, max_bucket_size());
         key_bucket_type& bucket_keys = m_keys[bucket];
+        value_bucket_type& bucket_values = m_value_manager[bucket];
         ON_DEBUG(key_type*& bucket_plainkeys = m_plainkeys[bucket];)
         const uint_fast8_t key_bitwidth = m_hash.remainder_width(m_buckets);
         DDCHECK_GT(key_bitwidth, 0);
@@ -655,8 +1368,8 @@ class separate_chaining_table {
 
         if(bucket_size == 0) {
             bucket_size = 1;
-            bucket_keys.initialize(resize_strategy_type::INITIAL_BUCKET_SIZE, key_width());
-            bucket_values.initialize(resize_strategy_type::INITIAL_BUCKET_SIZE, value_width());
+            bucket_keys.initialize(resize_strategy_type::INITIAL_BUCKET_SIZE, key_width(), m_allocator);
+            bucket_values.initialize(resize_strategy_type::INITIAL_BUCKET_SIZE, value_width(), m_allocator);
             m_resize_strategy.assign(resize_strategy_type::INITIAL_BUCKET_SIZE, bucket);
             ON_DEBUG(bucket_plainkeys   = reinterpret_cast<key_type*>  (malloc(sizeof(key_type))));
         } else {
@@ -664,9 +1377,10 @@ class separate_chaining_table {
             ON_DEBUG(bucket_plainkeys   = reinterpret_cast<key_type*>  (realloc(bucket_plainkeys, sizeof(key_type)*bucket_size));)
 
             if(m_resize_strategy.needs_resize(bucket_size, bucket)) {
+                m_instrumentation.bucket_resize(bucket_bytes(m_resize_strategy.size(bucket_size-1, bucket)));
                 const size_t newsize = m_resize_strategy.size_after_increment(bucket_size, bucket);
-                bucket_keys.resize(bucket_size-1, newsize, key_bitwidth);
-                bucket_values.resize(bucket_size-1, newsize, value_width());
+                bucket_keys.resize(bucket_size-1, newsize, key_bitwidth, m_allocator);
+                bucket_values.resize(bucket_size-1, newsize, value_width(), m_allocator);
             }
         }
         DDCHECK_LE(key, max_key());
@@ -680,13 +1394,36 @@ class separate_chaining_table {
         DDCHECK_EQ(m_hash.inv_map(bucket_keys.read(bucket_size-1, key_bitwidth), bucket, m_buckets), key);
 
         bucket_values.write(bucket_size-1, std::move(value), value_width());
-        return { *this, bucket, static_cast<size_t>(bucket_size-1) };
+        return bucket_size-1;
+    }
+
+    public:
+    /**
+     * Looks up the key `key` with quotient `quotient` in `bucket`, and appends it with `value` if it is not stored and `bucket` is not full.
+     * Returns the position of the key and whether it was inserted. The position is -1 if the key is not stored and `bucket` is full.
+     * Accesses only the data of `bucket`, and neither updates `m_elements` nor consults the overflow table, 
+     * such that calls on different buckets can run concurrently (see `striped_chaining_map`). Requires that no rehash is pending.
+     */
+    std::pair<size_t, bool> find_or_append_in_bucket(const size_t bucket, const storage_type& quotient, const key_type& key, value_type&& value) {
+        DDCHECK(m_rehash_source == nullptr);
+        DDCHECK_LT(bucket, bucket_count());
+        const size_t position = locate(bucket, quotient);
+        if(position != static_cast<size_t>(-1ULL)) {
+            return { position, false };
+        }
+        if(m_bucketsizes[bucket] >= bucket_cap()) {
+            return { static_cast<size_t>(-1ULL), false };
+        }
+        return { append(bucket, quotient, key, std::move(value)), true };
     }
 
     void write_value(const size_t bucket, const size_t position, const size_t value) {
         if(bucket == bucket_count()) {
             m_overflow[position] = value;
         }
+        else if(is_source_bucket(bucket)) {
+            m_rehash_source->write_value(bucket, position, value);
+        }
         else {
             DCHECK_LT(bucket, bucket_count());
             DCHECK_LE(value, (-1ULL)>>(64-value_width()));
@@ -695,7 +1432,7 @@ class separate_chaining_table {
     }
 
     navigator operator[](const key_type& key) {
-        return find_or_insert(key, value_type());
+        return try_emplace(key).first;
     }
 
     ~separate_chaining_table() { clear(); }
@@ -706,14 +1443,60 @@ class separate_chaining_table {
     }
 
     size_type erase(const size_t bucket, const size_t position) {
+        size_t moved_from;
+        return erase(bucket, position, moved_from);
+    }
+
+    /**
+     * Removes the element at `position` of `bucket`, and stores in `moved_from` the former position of the element
+     * that now occupies `position` in `bucket`, or -1 if there is none (see `erase_policy_type::moved_from`).
+     * A navigator on the moved element can be kept valid by setting it to `position`.
+     * Positions in the overflow table never move, such that `moved_from` is -1 for an element of the overflow table.
+     * Since the erasure may migrate buckets of a pending rehash or merge buckets (see `min_load_factor`), `moved_from` is only meaningful
+     * if `rehash_pending()` was false before and `bucket_count()` did not change.
+     */
+    size_type erase(const size_t bucket, const size_t position, size_t& moved_from) {
+        moved_from = -1ULL;
         if(position == static_cast<size_t>(-1ULL)) return 0;
         if(m_overflow.size() > 0 && bucket == bucket_count()) {
             DDCHECK_LT(position, m_overflow.capacity());
             m_overflow.erase(position);
             --m_elements;
+            shrink_step();
+            return 1;
+        }
+        if(is_source_bucket(bucket)) {
+            m_rehash_source->erase(bucket, position, moved_from);
+            --m_elements;
+            rehash_step();
             return 1;
         }
 
+        moved_from = erase_policy_type::moved_from(position, m_bucketsizes[bucket]);
+        erase_in_bucket(bucket, position);
+        --m_elements;
+        rehash_step();
+        shrink_step();
+        return 1;
+    }
+
+    private:
+    //! halves the number of buckets if the last erasure let `load_factor()` drop below `m_min_load_factor`
+    void shrink_step() {
+        if(m_min_load_factor == 0 || m_rehash_source != nullptr || bucket_count() <= separate_chaining::INITIAL_BUCKETS) return;
+        const float threshold = m_min_load_factor * bucket_count();
+        // only try when crossing the threshold, such that a table whose buckets cannot be merged is not scanned on each erasure
+        if(m_elements < threshold && m_elements+1 >= threshold) { merge_buckets(); }
+    }
+    public:
+
+    /**
+     * Removes the element at `position` of `bucket`, freeing the bucket if it becomes empty.
+     * Accesses only the data of `bucket` and does not update `m_elements`, 
+     * such that calls on different buckets can run concurrently (see `striped_chaining_map`). Requires that no rehash is pending.
+     */
+    void erase_in_bucket(const size_t bucket, const size_t position) {
+        DDCHECK(!is_source_bucket(bucket));
         DDCHECK_LT(bucket, bucket_count());
         DDCHECK_LT(position, m_bucketsizes[bucket]);
 
@@ -727,12 +1510,16 @@ class separate_chaining_table {
         DDCHECK_GT(key_bitwidth, 0);
         DDCHECK_LE(key_bitwidth, key_width());
 
-		bucket_keys.erase(position, bucket_size, key_bitwidth);
-		bucket_values.erase(position, bucket_size, value_width());
+		erase_policy_type::erase(bucket_keys, position, bucket_size, key_bitwidth);
+		erase_policy_type::erase(bucket_values, position, bucket_size, value_width());
 		ON_DEBUG(
         	key_type*& bucket_plainkeys = m_plainkeys[bucket];
-			for(size_t i = position+1; i < bucket_size; ++i) { 
-				bucket_plainkeys[i-1] = bucket_plainkeys[i];
+			if constexpr(erase_policy_type::preserves_order) {
+				for(size_t i = position+1; i < bucket_size; ++i) { 
+					bucket_plainkeys[i-1] = bucket_plainkeys[i];
+				}
+			} else {
+				bucket_plainkeys[position] = bucket_plainkeys[bucket_size-1];
 			})
 
         // for(size_t i = position+1; i < bucket_size; ++i) { 
@@ -743,11 +1530,9 @@ class separate_chaining_table {
         // }
         DDCHECK_GT(bucket_size, 0);
         --bucket_size;
-        --m_elements;
         if(bucket_size == 0) { //clear the bucket if it becomes empty
             clear(bucket);
         }
-        return 1;
     }
 
 
@@ -784,9 +1569,46 @@ class separate_chaining_table {
             bytes += m_value_manager.value_width() *(m_bucketsizes[bucket]);
         }
         bytes += m_overflow.size_in_bytes();
+        if(m_rehash_source != nullptr) { bytes += m_rehash_source->size_in_bytes(); }
         return bytes; 
     }
 
+    //! reports the distribution of the bucket sizes and the memory consumption, @see table_stats
+    table_stats stats() const {
+        table_stats stats;
+        stats.elements = m_elements;
+        stats.key_width = key_width();
+        stats.value_width = value_width();
+        stats.quotient_width = m_hash.remainder_width(m_buckets);
+        stats.overflow_elements = m_overflow.size();
+        stats.overflow_capacity = m_overflow.capacity();
+        stats.metadata_bytes = sizeof(class_type) + m_overflow.size_in_bytes() 
+            + bucket_count() * (sizeof(key_bucket_type) + value_manager_type::bytes_per_bucket + sizeof(bucketsize_type) + resize_strategy_type::bytes_per_bucket);
+        const size_t cbucket_count = bucket_count();
+        for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
+            stats.add_bucket(bucket_size(bucket));
+            if(m_bucketsizes[bucket] == 0) continue;
+            const size_t capacity = m_resize_strategy.size(m_bucketsizes[bucket], bucket);
+            stats.capacity += capacity;
+            stats.key_bytes += key_bucket_type::size_in_bytes(capacity, stats.quotient_width);
+            stats.value_bytes += value_bucket_type::size_in_bytes(capacity, value_width());
+        }
+        if(m_rehash_source != nullptr) { // the buckets not yet migrated are counted by `bucket_size` above
+            const table_stats source_stats = m_rehash_source->stats();
+            stats.capacity += source_stats.capacity;
+            stats.key_bytes += source_stats.key_bytes;
+            stats.value_bytes += source_stats.value_bytes;
+            stats.metadata_bytes += source_stats.metadata_bytes;
+        }
+        return stats;
+    }
+
+    //! counters of the hot paths, which are all zero unless `instrumentation_t` is `counting_instrumentation`
+    probe_counters counters() const { return m_instrumentation.counters(); }
+
+    //! sets all counters of `counters()` to zero
+    void reset_counters() { m_instrumentation.reset(); }
+
     void serialize(std::ostream& os) const {
         m_overflow.serialize(os);
         os.write(reinterpret_cast<const char*>(&m_key_width), sizeof(decltype(m_key_width)));
@@ -805,6 +1627,13 @@ class separate_chaining_table {
             m_value_manager[bucket].serialize(os, m_bucketsizes[bucket], value_width()); 
             ON_DEBUG(os.write(reinterpret_cast<const char*>(m_plainkeys[bucket]), sizeof(key_type)*m_bucketsizes[bucket]));
         }
+        os.write(reinterpret_cast<const char*>(&m_rehash_step), sizeof(decltype(m_rehash_step)));
+        const bool rehash_pending = m_rehash_source != nullptr;
+        os.write(reinterpret_cast<const char*>(&rehash_pending), sizeof(decltype(rehash_pending)));
+        if(rehash_pending) {
+            os.write(reinterpret_cast<const char*>(&m_rehash_cursor), sizeof(decltype(m_rehash_cursor)));
+            m_rehash_source->serialize(os);
+        }
     }
     void deserialize(std::istream& is) {
         clear();
@@ -827,8 +1656,8 @@ class separate_chaining_table {
 
         for(size_t bucket = 0; bucket < cbucket_count; ++bucket) {
             if(m_bucketsizes[bucket] == 0) continue;
-            m_keys[bucket].deserialize(is, m_bucketsizes[bucket], quotient_width); 
-            m_value_manager[bucket].deserialize(is, m_bucketsizes[bucket], value_width()); 
+            m_keys[bucket].deserialize(is, m_bucketsizes[bucket], quotient_width, m_allocator); 
+            m_value_manager[bucket].deserialize(is, m_bucketsizes[bucket], value_width(), m_allocator); 
 #ifndef NDEBUG
             {
                 const auto bucket_size = m_bucketsizes[bucket];
@@ -846,6 +1675,15 @@ class separate_chaining_table {
 #endif//NDEBUG
 
         }
+        is.read(reinterpret_cast<char*>(&m_rehash_step), sizeof(decltype(m_rehash_step)));
+        bool rehash_pending;
+        is.read(reinterpret_cast<char*>(&rehash_pending), sizeof(decltype(rehash_pending)));
+        if(rehash_pending) {
+            is.read(reinterpret_cast<char*>(&m_rehash_cursor), sizeof(decltype(m_rehash_cursor)));
+            m_rehash_source = new separate_chaining_table(m_key_width, m_value_width);
+            m_rehash_source->deserialize(is);
+            ON_DEBUG(restored_elements += m_rehash_source->m_elements;)
+        }
         DDCHECK_EQ(m_elements, restored_elements);
     }
 
@@ -854,12 +1692,12 @@ class separate_chaining_table {
 
 
 //! typedef for hash map
-template<class key_bucket_t, class value_bucket_t, class hash_mapping_t, class resize_strategy_t = incremental_resize, template<class K, class V> class overflow_t = dummy_overflow>
-using separate_chaining_map = separate_chaining_table<key_bucket_t, value_array_manager<value_bucket_t>, hash_mapping_t, resize_strategy_t, overflow_t>;
+template<class key_bucket_t, class value_bucket_t, class hash_mapping_t, class resize_strategy_t = incremental_resize, template<class K, class V> class overflow_t = dummy_overflow, class allocator_t = malloc_allocator, class erase_policy_t = ordered_erase, class instrumentation_t = no_instrumentation>
+using separate_chaining_map = separate_chaining_table<key_bucket_t, value_array_manager<value_bucket_t>, hash_mapping_t, resize_strategy_t, overflow_t, allocator_t, erase_policy_t, instrumentation_t>;
 
 //! typedef for hash set
-template<class key_bucket_t, class hash_mapping_t, class resize_strategy_t = incremental_resize, template<class K, class V> class overflow_t = dummy_overflow> 
-using separate_chaining_set = separate_chaining_table<key_bucket_t, value_dummy_manager, hash_mapping_t, resize_strategy_t, overflow_t>;
+template<class key_bucket_t, class hash_mapping_t, class resize_strategy_t = incremental_resize, template<class K, class V> class overflow_t = dummy_overflow, class allocator_t = malloc_allocator, class erase_policy_t = ordered_erase, class instrumentation_t = no_instrumentation> 
+using separate_chaining_set = separate_chaining_table<key_bucket_t, value_dummy_manager, hash_mapping_t, resize_strategy_t, overflow_t, allocator_t, erase_policy_t, instrumentation_t>;
 
 
 typename value_dummy_manager::value_bucket_type value_dummy_manager::m_bucket;
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <iostream>
+#include "dcheck.hpp"
+#include "math.hpp"
+#include "hash.hpp"
+
+namespace separate_chaining {
+
+/**
+ * Thread-safe hash table consisting of `shard_count` many independent hash tables of type `map_type`,
+ * e.g., a `separate_chaining_map` or a `separate_chaining_set`.
+ * A key is routed to a shard by the highest bits of its hash value computed by `router_function`.
+ * Inside a shard, the key is stored as usual, i.e., quotiented by the hash mapping of the shard.
+ * Each shard is guarded by its own reader-writer lock such that
+ * lookups in the same shard can run in parallel, while modifications of different shards do not block each other.
+ *
+ * Since a shard can be modified by another thread at any time, the interface returns copies of values instead of iterators.
+ *
+ * map_type: hash table with the interface of `separate_chaining_table`
+ * shard_count: number of shards, needs to be a power of two
+ * router_function: hash function used for routing, should be independent of the hash mapping of `map_type`
+ */
+template<class map_type, size_t shard_count = 64, class router_function = SplitMix>
+class sharded_chaining_map {
+   static_assert(shard_count > 0 && (shard_count & (shard_count-1)) == 0, "shard_count must be a power of two");
+
+   public:
+   using shard_map_type = map_type;
+   using key_type = typename map_type::key_type;
+   using value_type = typename map_type::value_type;
+   using size_type = typename map_type::size_type;
+   using mutex_type = std::shared_mutex;
+   using class_type = sharded_chaining_map<map_type, shard_count, router_function>;
+
+   static constexpr uint_fast8_t m_shard_bits = most_significant_bit(shard_count); //! number of hash bits used for routing
+
+   private:
+   //! a hash table with its lock, padded to a cache line such that locks of different shards do not share a cache line
+   struct alignas(64) shard_type {
+      mutable mutex_type m_mutex;
+      map_type m_map;
+   };
+
+   shard_type m_shards[shard_count];
+   router_function m_router;
+
+   public:
+   sharded_chaining_map(uint_fast8_t key_width = sizeof(key_type)*8, uint_fast8_t value_width = sizeof(value_type)*8) {
+      for(size_t i = 0; i < shard_count; ++i) {
+         m_shards[i].m_map = map_type(key_width, value_width);
+      }
+   }
+
+   sharded_chaining_map(const sharded_chaining_map&) = delete;
+   sharded_chaining_map& operator=(const sharded_chaining_map&) = delete;
+
+   //! returns the shard responsible for `key`
+   size_t shard_of(const key_type& key) const {
+      if constexpr (m_shard_bits == 0) { return 0; }
+      else { return static_cast<uint64_t>(m_router(key)) >> (64 - m_shard_bits); }
+   }
+
+   static constexpr size_t shards() { return shard_count; }
+
+   //! returns the maximum value of a key that can be stored
+   key_type max_key() const { return m_shards[0].m_map.max_key(); }
+   value_type max_value() const { return m_shards[0].m_map.max_value(); }
+   uint_fast8_t key_width() const { return m_shards[0].m_map.key_width(); }
+   uint_fast8_t value_width() const { return m_shards[0].m_map.value_width(); }
+
+   /**
+    * Looks up `key` and stores its value in `value`.
+    * Returns whether `key` is stored in the hash table.
+    */
+   bool find(const key_type& key, value_type& value) const {
+      const shard_type& shard = m_shards[shard_of(key)];
+      std::shared_lock<mutex_type> lock(shard.m_mutex);
+      const auto it = shard.m_map.find(key);
+      if(it == shard.m_map.cend()) { return false; }
+      value = it->second;
+      return true;
+   }
+
+   //! @see std::set
+   size_type count(const key_type& key) const {
+      const shard_type& shard = m_shards[shard_of(key)];
+      std::shared_lock<mutex_type> lock(shard.m_mutex);
+      return shard.m_map.count(key);
+   }
+
+   /**
+    * Inserts `key` with `value` if `key` is not yet stored.
+    * Returns the value stored with `key` after the operation.
+    */
+   value_type find_or_insert(const key_type& key, value_type&& value) {
+      shard_type& shard = m_shards[shard_of(key)];
+      std::unique_lock<mutex_type> lock(shard.m_mutex);
+      return shard.m_map.find_or_insert(key, std::move(value)).value();
+   }
+
+   //! stores `value` with `key`, overwriting a possibly stored value
+   void assign(const key_type& key, const value_type& value) {
+      shard_type& shard = m_shards[shard_of(key)];
+      std::unique_lock<mutex_type> lock(shard.m_mutex);
+      shard.m_map[key] = value;
+   }
+
+   /**
+    * Inserts `key` with `value` if `key` is not yet stored.
+    * Otherwise, replaces the stored value `v` with `merge(v, value)`, e.g., `std::plus` for counting.
+    * Returns the value stored with `key` after the operation.
+    */
+   template<class merge_function>
+   value_type upsert(const key_type& key, const value_type& value, merge_function&& merge) {
+      shard_type& shard = m_shards[shard_of(key)];
+      std::unique_lock<mutex_type> lock(shard.m_mutex);
+      return shard.m_map.upsert(key, value, std::forward<merge_function>(merge)).first.value();
+   }
+
+   //! @see std::unordered_map
+   size_type erase(const key_type& key) {
+      shard_type& shard = m_shards[shard_of(key)];
+      std::unique_lock<mutex_type> lock(shard.m_mutex);
+      return shard.m_map.erase(key);
+   }
+
+   //! number of stored elements, not a snapshot if other threads modify the table meanwhile
+   size_t size() const {
+      size_t elements = 0;
+      for(size_t i = 0; i < shard_count; ++i) {
+         std::shared_lock<mutex_type> lock(m_shards[i].m_mutex);
+         elements += m_shards[i].m_map.size();
+      }
+      return elements;
+   }
+
+   //! @see std::unordered_map
+   bool empty() const { return size() == 0; }
+
+   //! number of elements stored in the `shard`-th shard
+   size_t shard_size(const size_t shard) const {
+      DDCHECK_LT(shard, shard_count);
+      std::shared_lock<mutex_type> lock(m_shards[shard].m_mutex);
+      return m_shards[shard].m_map.size();
+   }
+
+   //! reserves space for `reserve` elements in total, spread evenly among all shards
+   void reserve(const size_t reserve) {
+      for(size_t i = 0; i < shard_count; ++i) {
+         std::unique_lock<mutex_type> lock(m_shards[i].m_mutex);
+         m_shards[i].m_map.reserve(ceil_div<size_t>(reserve, shard_count));
+      }
+   }
+
+   void shrink_to_fit() {
+      for(size_t i = 0; i < shard_count; ++i) {
+         std::unique_lock<mutex_type> lock(m_shards[i].m_mutex);
+         m_shards[i].m_map.shrink_to_fit();
+      }
+   }
+
+   void clear() {
+      for(size_t i = 0; i < shard_count; ++i) {
+         std::unique_lock<mutex_type> lock(m_shards[i].m_mutex);
+         m_shards[i].m_map.clear();
+      }
+   }
+
+   //! number of bytes the hash table uses
+   size_type size_in_bytes() const {
+      size_t bytes = sizeof(class_type) - shard_count * sizeof(map_type);
+      for(size_t i = 0; i < shard_count; ++i) {
+         std::shared_lock<mutex_type> lock(m_shards[i].m_mutex);
+         bytes += m_shards[i].m_map.size_in_bytes();
+      }
+      return bytes;
+   }
+
+   /**
+    * Writes all shards to `os`.
+    * All shards are locked for reading during the operation to obtain a consistent snapshot.
+    * Since a writer holds at most one lock at a time, locking the shards in order cannot deadlock.
+    */
+   void serialize(std::ostream& os) const {
+      for(size_t i = 0; i < shard_count; ++i) { m_shards[i].m_mutex.lock_shared(); }
+      const size_t shards = shard_count;
+      os.write(reinterpret_cast<const char*>(&shards), sizeof(decltype(shards)));
+      for(size_t i = 0; i < shard_count; ++i) {
+         m_shards[i].m_map.serialize(os);
+      }
+      for(size_t i = 0; i < shard_count; ++i) { m_shards[i].m_mutex.unlock_shared(); }
+   }
+
+   void deserialize(std::istream& is) {
+      for(size_t i = 0; i < shard_count; ++i) { m_shards[i].m_mutex.lock(); }
+      size_t shards;
+      is.read(reinterpret_cast<char*>(&shards), sizeof(decltype(shards)));
+      DCHECK_EQ(shards, shard_count);
+      for(size_t i = 0; i < shard_count; ++i) {
+         m_shards[i].m_map.deserialize(is);
+      }
+      for(size_t i = 0; i < shard_count; ++i) { m_shards[i].m_mutex.unlock(); }
+   }
+};
+
+}//ns separate_chaining
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+#include <immintrin.h>
+
+namespace separate_chaining {
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+//! defined if the compiler supports function-level x86 target attributes, such that the AVX2 and AVX-512 kernels are compiled regardless of `-march`
+#define SEPARATE_X86_TARGETS 1
+//! compiles a function with AVX2 instructions regardless of the `-march` flags of the build; it must only be called if `avx2_supported()`
+#define SEPARATE_TARGET_AVX2 __attribute__((target("avx2")))
+//! compiles a function with AVX-512 instructions regardless of the `-march` flags of the build; it must only be called if `avx512_supported()`
+#define SEPARATE_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+//! whether the running CPU executes AVX2 instructions
+inline bool avx2_supported() {
+   static const bool supported = __builtin_cpu_supports("avx2");
+   return supported;
+}
+
+//! whether the running CPU executes the AVX-512 instructions (foundation and byte/word) used by `avx512_bucket`
+inline bool avx512_supported() {
+   static const bool supported = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+   return supported;
+}
+
+/**
+ * `match(data, n, key)` compares the elements of `data` fitting into 512 bits with `key`, and returns a bit mask whose `i`-th bit is set if the `i`-th element equals `key`.
+ * If `n` is smaller than the number of these elements, the elements after the `n`-th are masked out of the load, such that they are neither read nor can they fault.
+ */
+template<class storage_t>
+struct avx512_functions;
+
+template<>
+struct avx512_functions<uint8_t> {
+   SEPARATE_TARGET_AVX512 static uint64_t match(const uint8_t* data, const size_t n, const uint8_t key) {
+      const __mmask64 lanes = n >= 64 ? ~0ULL : (1ULL<<n)-1;
+      return _mm512_mask_cmpeq_epi8_mask(lanes, _mm512_maskz_loadu_epi8(lanes, data), _mm512_set1_epi8(key));
+   }
+};
+
+template<>
+struct avx512_functions<uint16_t> {
+   SEPARATE_TARGET_AVX512 static uint64_t match(const uint16_t* data, const size_t n, const uint16_t key) {
+      const __mmask32 lanes = n >= 32 ? ~0U : (1U<<n)-1;
+      return _mm512_mask_cmpeq_epi16_mask(lanes, _mm512_maskz_loadu_epi16(lanes, data), _mm512_set1_epi16(key));
+   }
+};
+
+template<>
+struct avx512_functions<uint32_t> {
+   SEPARATE_TARGET_AVX512 static uint64_t match(const uint32_t* data, const size_t n, const uint32_t key) {
+      const __mmask16 lanes = n >= 16 ? 0xFFFF : (1U<<n)-1;
+      return _mm512_mask_cmpeq_epi32_mask(lanes, _mm512_maskz_loadu_epi32(lanes, data), _mm512_set1_epi32(key));
+   }
+};
+
+template<>
+struct avx512_functions<uint64_t> {
+   SEPARATE_TARGET_AVX512 static uint64_t match(const uint64_t* data, const size_t n, const uint64_t key) {
+      const __mmask8 lanes = n >= 8 ? 0xFF : (1U<<n)-1;
+      return _mm512_mask_cmpeq_epi64_mask(lanes, _mm512_maskz_loadu_epi64(lanes, data), _mm512_set1_epi64(key));
+   }
+};
+#endif// SEPARATE_X86_TARGETS
+
+/**
+ * Search kernels returning the first position `i < length` with `data[i] == key`, or -1ULL if there is none.
+ * All kernels of the same storage type are interchangeable; `find_kernel` selects one by instruction set,
+ * and `dispatched_find` selects the fastest one the running CPU supports, once per process.
+ * The kernels read `data` with unaligned loads, such that the data needs no alignment beyond that of `storage_t`.
+ */
+namespace simd {
+
+//! instruction sets of the search kernels, from the slowest to the fastest
+enum class isa : uint8_t {
+   scalar, //! one comparison per element
+   swar, //! compares all elements fitting into 64 bits at once with integer arithmetic (SIMD within a register)
+   avx2, //! compares 256 bits at once
+   avx512, //! compares 512 bits at once, with a masked load for the last chunk
+};
+
+inline const char* isa_name(const isa level) {
+   switch(level) {
+      case isa::scalar: return "scalar";
+      case isa::swar: return "swar";
+      case isa::avx2: return "avx2";
+      case isa::avx512: return "avx512";
+   }
+   return "unknown";
+}
+
+//! whether the running CPU can execute the kernels of `level`
+inline bool supported(const isa level) {
+   switch(level) {
+      case isa::scalar:
+      case isa::swar:
+         return true;
+#ifdef SEPARATE_X86_TARGETS
+      case isa::avx2: return avx2_supported();
+      case isa::avx512: return avx512_supported();
+#else
+      case isa::avx2:
+      case isa::avx512:
+         return false;
+#endif
+   }
+   return false;
+}
+
+/**
+ * The fastest instruction set supported by the running CPU, detected at the first call.
+ * The environment variable `SEPARATE_ISA` (`scalar`, `swar`, `avx2` or `avx512`) caps it, e.g., for emulating an older CPU.
+ */
+inline isa best_isa() {
+   static const isa best = [] {
+      isa cap = isa::avx512;
+      if(const char* name = std::getenv("SEPARATE_ISA")) {
+         for(const isa level : { isa::scalar, isa::swar, isa::avx2, isa::avx512 }) {
+            if(std::strcmp(name, isa_name(level)) == 0) { cap = level; }
+         }
+      }
+      for(const isa level : { isa::avx512, isa::avx2, isa::swar }) {
+         if(level <= cap && supported(level)) { return level; }
+      }
+      return isa::scalar;
+   }();
+   return best;
+}
+
+template<class storage_t>
+size_t find_scalar(const storage_t* data, const size_t length, const storage_t key) {
+   for(size_t i = 0; i < length; ++i) {
+      if(data[i] == key) return i;
+   }
+   return -1ULL;
+}
+
+/**
+ * Compares the 64/(8*sizeof(storage_t)) elements of a word with `key` by detecting a zero lane in `word ^ broadcast(key)`.
+ * A borrow of `x - low` can only flag a lane above a zero lane, such that the least significant flagged lane is the first match.
+ * Falls back to `find_scalar` for 64-bit elements and on big-endian machines.
+ */
+template<class storage_t>
+size_t find_swar(const storage_t* data, const size_t length, const storage_t key) {
+   if constexpr(sizeof(storage_t) >= sizeof(uint64_t) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) {
+      return find_scalar(data, length, key);
+   } else {
+      constexpr size_t lane_bits = sizeof(storage_t)*8;
+      constexpr size_t lanes = sizeof(uint64_t)/sizeof(storage_t);
+      constexpr uint64_t low = (-1ULL) / ((1ULL<<lane_bits)-1); //! the least significant bit of each lane
+      constexpr uint64_t high = low << (lane_bits-1); //! the most significant bit of each lane
+      const uint64_t pattern = low * static_cast<uint64_t>(static_cast<std::make_unsigned_t<storage_t>>(key)); // without sign extension
+      size_t i = 0;
+      for(; i + lanes <= length; i += lanes) {
+         uint64_t word;
+         std::memcpy(&word, data+i, sizeof(uint64_t));
+         const uint64_t x = word ^ pattern;
+         const uint64_t zero = (x - low) & ~x & high;
+         if(zero != 0) { return i + __builtin_ctzll(zero)/lane_bits; }
+      }
+      for(; i < length; ++i) {
+         if(data[i] == key) return i;
+      }
+      return -1ULL;
+   }
+}
+
+#ifdef SEPARATE_X86_TARGETS
+template<class storage_t>
+SEPARATE_TARGET_AVX2 size_t find_avx2(const storage_t* data, const size_t length, const storage_t key) {
+   constexpr size_t register_size = 32/sizeof(storage_t); // number of `storage_t` elements fitting in 256 bits = 32 bytes
+   __m256i pattern;
+   if constexpr(sizeof(storage_t) == 1) { pattern = _mm256_set1_epi8(static_cast<char>(key)); }
+   else if constexpr(sizeof(storage_t) == 2) { pattern = _mm256_set1_epi16(static_cast<short>(key)); }
+   else if constexpr(sizeof(storage_t) == 4) { pattern = _mm256_set1_epi32(static_cast<int>(key)); }
+   else { pattern = _mm256_set1_epi64x(static_cast<long long>(key)); }
+   size_t i = 0;
+   for(; i + register_size <= length; i += register_size) {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i));
+      __m256i equal;
+      if constexpr(sizeof(storage_t) == 1) { equal = _mm256_cmpeq_epi8(chunk, pattern); }
+      else if constexpr(sizeof(storage_t) == 2) { equal = _mm256_cmpeq_epi16(chunk, pattern); }
+      else if constexpr(sizeof(storage_t) == 4) { equal = _mm256_cmpeq_epi32(chunk, pattern); }
+      else { equal = _mm256_cmpeq_epi64(chunk, pattern); }
+      const uint32_t mask = _mm256_movemask_epi8(equal);
+      if(mask != 0) { return i + __builtin_ctz(mask)/sizeof(storage_t); }
+   }
+   for(; i < length; ++i) {
+      if(data[i] == key) return i;
+   }
+   return -1ULL;
+}
+
+template<class storage_t>
+SEPARATE_TARGET_AVX512 size_t find_avx512(const storage_t* data, const size_t length, const storage_t key) {
+   constexpr size_t register_size = 64/sizeof(storage_t); // number of `storage_t` elements fitting in 512 bits = 64 bytes
+   for(size_t i = 0; i < length; i += register_size) {
+      const uint64_t mask = avx512_functions<storage_t>::match(data+i, length-i, key);
+      if(mask != 0) { return i + __builtin_ctzll(mask); }
+   }
+   return -1ULL;
+}
+
+//! the largest bit width of the fields `find_packed_avx2` can search
+constexpr uint_fast8_t packed_avx2_max_width = 32;
+
+/**
+ * Searches `key` in `length` fields of `width` bits packed in `data` as written by `varwidth_bucket`, i.e., the `i`-th field occupies the bits `[i*width, (i+1)*width)` counted from the least significant bit of the first byte.
+ * `data` has to provide `ceil(length*width/8)` bytes; the kernel never reads beyond them.
+ * Eight consecutive fields occupy exactly `width` bytes, such that each iteration loads 32 bytes at the next multiple of `width` bytes,
+ * and each field has the same position within these bytes in every iteration.
+ * The `j`-th 32-bit lane gathers the two dwords covering its field with a cross-lane permutation, and funnel shifts them by the bit offset of the field.
+ * Near the end, a masked load reads the remaining complete dwords, the last 0 to 3 bytes are inserted separately, and the lanes beyond `length` are ignored.
+ */
+SEPARATE_TARGET_AVX2 inline size_t find_packed_avx2(const uint8_t* data, const size_t length, const uint_fast8_t width, const uint64_t key) {
+   if(width < 64 && (key >> width) != 0) { return -1ULL; }
+   const size_t bytes = (length*width + 7)/8;
+   const __m256i position = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(width)); // bit position of the field of each lane
+   const __m256i low_index = _mm256_srli_epi32(position, 5);
+   const __m256i high_index = _mm256_add_epi32(low_index, _mm256_set1_epi32(1)); // the permutation takes the index modulo 8; a lane not reaching the next dword shifts its bits out of the mask
+   const __m256i right_shift = _mm256_and_si256(position, _mm256_set1_epi32(31));
+   const __m256i left_shift = _mm256_sub_epi32(_mm256_set1_epi32(32), right_shift); // a shift by 32 gives zero
+   const __m256i mask = _mm256_set1_epi32(static_cast<int>(width >= 32 ? -1U : (1U<<width)-1));
+   const __m256i pattern = _mm256_set1_epi32(static_cast<int>(key));
+
+   for(size_t i = 0, offset = 0; i < length; i += 8, offset += width) {
+      __m256i chunk;
+      if(offset + 32 <= bytes) {
+         chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+offset));
+      } else {
+         const int dwords = static_cast<int>((bytes-offset)/4); // complete dwords before the end
+         const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+         chunk = _mm256_maskload_epi32(reinterpret_cast<const int*>(data+offset), _mm256_cmpgt_epi32(_mm256_set1_epi32(dwords), lane));
+         const size_t remaining = bytes - offset - 4*dwords; // the 0 to 3 bytes after the complete dwords
+         uint32_t partial = 0;
+         if(remaining > 0 && bytes >= 4) { // read the last dword of `data`, and shift out the bytes of the complete dwords
+            std::memcpy(&partial, data+bytes-4, 4);
+            partial >>= 8*(4-remaining);
+         } else {
+            for(size_t byte = 0; byte < remaining; ++byte) { partial |= static_cast<uint32_t>(data[bytes-remaining+byte]) << (8*byte); }
+         }
+         chunk = _mm256_blendv_epi8(chunk, _mm256_set1_epi32(static_cast<int>(partial)), _mm256_cmpeq_epi32(_mm256_set1_epi32(dwords), lane));
+      }
+      const __m256i low = _mm256_srlv_epi32(_mm256_permutevar8x32_epi32(chunk, low_index), right_shift);
+      const __m256i high = _mm256_sllv_epi32(_mm256_permutevar8x32_epi32(chunk, high_index), left_shift);
+      const __m256i fields = _mm256_and_si256(_mm256_or_si256(low, high), mask);
+      uint32_t found = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(fields, pattern)));
+      if(length - i < 8) { found &= (1U<<(length-i))-1; }
+      if(found != 0) { return i + __builtin_ctz(found); }
+   }
+   return -1ULL;
+}
+#endif// SEPARATE_X86_TARGETS
+
+template<class storage_t>
+using find_function = size_t (*)(const storage_t* data, const size_t length, const storage_t key);
+
+//! the kernel of the instruction set `level`; a kernel of an instruction set not compiled in falls back to `find_swar`
+template<class storage_t>
+find_function<storage_t> find_kernel(const isa level) {
+   switch(level) {
+      case isa::scalar: return find_scalar<storage_t>;
+#ifdef SEPARATE_X86_TARGETS
+      case isa::avx2: return find_avx2<storage_t>;
+      case isa::avx512: return find_avx512<storage_t>;
+#endif
+      default: return find_swar<storage_t>;
+   }
+}
+
+//! the kernel of `best_isa()`, looked up once per process and storage type
+template<class storage_t>
+find_function<storage_t> dispatched_find() {
+   static const find_function<storage_t> kernel = find_kernel<storage_t>(best_isa());
+   return kernel;
+}
+
+}//ns simd
+}//ns separate_chaining
@@ -2,6 +2,7 @@
 
 namespace separate_chaining {
     static constexpr size_t INITIAL_BUCKETS = 16; //! number of buckets a separate hash table holds initially
+    static constexpr size_t REHASH_VISITS_PER_STEP = 16; //! number of old buckets, empty or not, an incremental rehash visits at most per bucket it migrates in an operation
     using bucketsize_type = uint8_t; //! type for storing the sizes of the buckets
     //static constexpr size_t MAX_BUCKET_BYTESIZE = 128;
     static constexpr size_t MAX_BUCKET_BYTESIZE = std::numeric_limits<bucketsize_type>::max(); //! maximum number of elements a bucket can store
@@ -11,6 +12,7 @@ namespace separate_chaining {
 //! let a full bucket grow incrementally on insertion such that there is no need to store the capacity of a bucket (since it is always full)
 struct incremental_resize {
     static constexpr size_t INITIAL_BUCKET_SIZE = 1; //! number of elements a bucket can store initially
+    static constexpr size_t bytes_per_bucket = 0; //! no capacities are stored
 
     constexpr static void allocate([[maybe_unused]]const size_t new_size)  {
     }
@@ -35,6 +37,7 @@ class arbitrary_resize {
     public:
     using bucketsize_type = separate_chaining::bucketsize_type; //! used for storing the sizes of the buckets
     static constexpr size_t INITIAL_BUCKET_SIZE = 1; //! number of elements a bucket can store initially
+    static constexpr size_t bytes_per_bucket = sizeof(bucketsize_type); //! stores the capacity of each bucket
 
     //private:
     bucketsize_type* m_maxbucketsizes = nullptr; //! size of each bucket
@@ -104,4 +107,24 @@ class arbitrary_resize {
 };
 
 
+/**
+ * Decides at runtime when a `separate_chaining_table` doubles its number of buckets.
+ * The defaults reproduce the behavior of a table without a policy: the table grows when a bucket holding `max_bucket_size()` elements
+ * receives another element that the overflow table cannot take.
+ */
+struct growth_policy {
+    //! the table grows before an insertion lets `load_factor()` exceed this value, 0 disables growing by load
+    float max_load_factor = 0;
+
+    //! number of elements at which a bucket counts as full, clamped to `max_bucket_size()`
+    size_t bucket_cap = std::numeric_limits<size_t>::max();
+
+    /**
+     * A full bucket is hot if `load_factor()` is below this value. Instead of doubling the table for a hot bucket, 
+     * its new elements go to the overflow table, or, if the overflow table cannot take them, the bucket grows beyond `bucket_cap` up to `max_bucket_size()`.
+     * This keeps a few overfull buckets of skewed inputs from doubling a sparse table. 0 disables hot buckets.
+     */
+    float hot_load_factor = 0;
+};
+
 }//namespace separate_chaining
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace separate_chaining {
+
+/**
+ * Shape and memory consumption of a hash table, returned by the `stats()` member function of the tables.
+ * Unlike `print_stats`, it does not depend on tudocomp, and can be written as JSON for tuning the configuration of a table in production.
+ * The byte counts are split into the arrays storing the keys (i.e., quotients), the arrays storing the values,
+ * and all other memory such as the bucket pointers, the bucket sizes, and the overflow table.
+ */
+struct table_stats {
+    size_t elements = 0; //! number of stored elements, including those in the overflow table
+    size_t bucket_count = 0;
+    size_t empty_buckets = 0;
+    size_t max_chain_length = 0; //! number of elements of the largest bucket
+    std::vector<size_t> bucket_size_histogram; //! the `i`-th entry is the number of buckets with `i` elements
+    size_t overflow_elements = 0;
+    size_t overflow_capacity = 0;
+    unsigned key_width = 0;
+    unsigned value_width = 0;
+    unsigned quotient_width = 0; //! bit width of the quotients stored in the buckets
+    size_t key_bytes = 0;
+    size_t value_bytes = 0;
+    size_t metadata_bytes = 0;
+    size_t capacity = 0; //! number of elements the allocated buckets can store without reallocation
+
+    //! counts a bucket with `size` elements
+    void add_bucket(const size_t size) {
+        ++bucket_count;
+        if(size == 0) { ++empty_buckets; }
+        if(size >= bucket_size_histogram.size()) { bucket_size_histogram.resize(size+1, 0); }
+        ++bucket_size_histogram[size];
+        max_chain_length = std::max(max_chain_length, size);
+    }
+
+    //! number of elements stored in the buckets, i.e., not in the overflow table
+    size_t bucket_elements() const { return elements - overflow_elements; }
+
+    //! average number of elements of a non-empty bucket, i.e., the expected length of a chain scanned by a successful lookup
+    double average_chain_length() const {
+        return bucket_count == empty_buckets ? 0 : static_cast<double>(bucket_elements()) / (bucket_count - empty_buckets);
+    }
+
+    //! @see std::unordered_map
+    double load_factor() const {
+        return bucket_count == 0 ? 0 : static_cast<double>(bucket_elements()) / bucket_count;
+    }
+
+    //! number of allocated but unused element slots in the buckets
+    size_t capacity_slack() const { return capacity - bucket_elements(); }
+
+    //! total number of bytes
+    size_t bytes() const { return key_bytes + value_bytes + metadata_bytes; }
+
+    void to_json(std::ostream& os) const {
+        os << "{"
+           << "\"elements\":" << elements
+           << ",\"bucket_count\":" << bucket_count
+           << ",\"empty_buckets\":" << empty_buckets
+           << ",\"load_factor\":" << load_factor()
+           << ",\"average_chain_length\":" << average_chain_length()
+           << ",\"max_chain_length\":" << max_chain_length
+           << ",\"bucket_size_histogram\":[";
+        for(size_t i = 0; i < bucket_size_histogram.size(); ++i) {
+            os << (i == 0 ? "" : ",") << bucket_size_histogram[i];
+        }
+        os << "]"
+           << ",\"overflow_elements\":" << overflow_elements
+           << ",\"overflow_capacity\":" << overflow_capacity
+           << ",\"key_width\":" << key_width
+           << ",\"value_width\":" << value_width
+           << ",\"quotient_width\":" << quotient_width
+           << ",\"key_bytes\":" << key_bytes
+           << ",\"value_bytes\":" << value_bytes
+           << ",\"metadata_bytes\":" << metadata_bytes
+           << ",\"bytes\":" << bytes()
+           << ",\"capacity\":" << capacity
+           << ",\"capacity_slack\":" << capacity_slack()
+           << "}";
+    }
+
+    std::string to_json() const {
+        std::stringstream ss;
+        to_json(ss);
+        return ss.str();
+    }
+};
+
+}//ns separate_chaining
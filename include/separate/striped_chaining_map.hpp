@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include "dcheck.hpp"
+#include "allocator.hpp"
+#include "size.hpp"
+
+namespace separate_chaining {
+
+//! test-and-test-and-set lock occupying a single byte, yielding after `SPIN_LIMIT` unsuccessful spins in case the holder got descheduled
+class spinlock {
+    static constexpr size_t SPIN_LIMIT = 64;
+    std::atomic<bool> m_locked { false };
+
+    public:
+    void lock() {
+        while(m_locked.exchange(true, std::memory_order_acquire)) {
+            for(size_t spins = 0; m_locked.load(std::memory_order_relaxed); ++spins) {
+                if(spins >= SPIN_LIMIT) { std::this_thread::yield(); continue; }
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            }
+        }
+    }
+    bool try_lock() { return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire); }
+    void unlock() { m_locked.store(false, std::memory_order_release); }
+};
+
+/**
+ * Thread-safe wrapper around a single hash table of type `map_type` (e.g., `separate_chaining_map`) with fine-grained locking.
+ * The buckets are partitioned into `stripe_count` stripes, where bucket `b` belongs to stripe `b mod stripe_count`.
+ * Each stripe is guarded by a spinlock, such that operations on keys of different stripes do not block each other.
+ *
+ * Growing the table is coordinated by a reader-writer resize lock:
+ * every operation holds it in shared mode, and an insertion into a full bucket upgrades to exclusive mode,
+ * in which it is processed by the sequential `find_or_insert` of `map_type` that may grow the table or use its overflow table.
+ *
+ * Since bucket arrays are (re)allocated concurrently, `map_type` has to use `malloc_allocator`.
+ * Incremental rehashing of `map_type` is not used.
+ *
+ * map_type: `separate_chaining_table` with `malloc_allocator`
+ * stripe_count: number of spinlocks, needs to be a power of two
+ */
+template<class map_type, size_t stripe_count = 4096>
+class striped_chaining_map {
+   static_assert(stripe_count > 0 && (stripe_count & (stripe_count-1)) == 0, "stripe_count must be a power of two");
+   static_assert(std::is_same<typename map_type::allocator_type, malloc_allocator>::value, "buckets are allocated concurrently, which requires malloc_allocator");
+
+   public:
+   using shard_map_type = map_type;
+   using key_type = typename map_type::key_type;
+   using value_type = typename map_type::value_type;
+   using size_type = typename map_type::size_type;
+   using class_type = striped_chaining_map<map_type, stripe_count>;
+
+   private:
+   map_type m_map;
+   mutable std::shared_mutex m_resize_mutex; //! shared by all operations, exclusive when the table grows
+   mutable spinlock m_locks[stripe_count]; //! the lock of the `i`-th stripe guards all buckets `b` with `b mod stripe_count = i`
+   std::atomic<size_t> m_elements { 0 }; //! number of stored elements, `m_map.size()` is only synchronized on growing
+
+   spinlock& stripe_lock(const size_t bucket) const { return m_locks[bucket & (stripe_count-1)]; }
+
+   //! inserts `key` with `value` into the full bucket of `key` while holding the exclusive resize lock; returns whether `key` was inserted
+   template<class function_type>
+   bool insert_exclusive(const key_type& key, value_type&& value, function_type&& on_found) {
+      std::unique_lock<std::shared_mutex> lock(m_resize_mutex);
+      m_map.m_elements = m_elements.load(std::memory_order_relaxed);
+      auto it = m_map.find_or_insert(key, std::move(value));
+      const bool inserted = m_map.size() != m_elements.load(std::memory_order_relaxed);
+      if(!inserted) { on_found(it); }
+      m_elements.store(m_map.size(), std::memory_order_relaxed);
+      return inserted;
+   }
+
+   /**
+    * Core of the insertion operations: inserts `key` with `value` if it is not stored.
+    * Otherwise, calls `on_found` with a navigator to the stored element while holding the lock of its stripe.
+    */
+   template<class function_type>
+   bool insert(const key_type& key, value_type&& value, function_type&& on_found) {
+      {
+         std::shared_lock<std::shared_mutex> resize_lock(m_resize_mutex);
+         const auto [quotient, bucket] = m_map.m_hash.map(key, m_map.bucket_count_log2());
+         std::lock_guard<spinlock> lock(stripe_lock(bucket));
+         if(!m_map.m_overflow.need_consult(bucket) || m_map.m_overflow.find(key) == static_cast<size_t>(-1ULL)) {
+            const auto [position, inserted] = m_map.find_or_append_in_bucket(bucket, quotient, key, std::move(value));
+            if(inserted) {
+               m_elements.fetch_add(1, std::memory_order_relaxed);
+               return true;
+            }
+            if(position != static_cast<size_t>(-1ULL)) {
+               auto it = typename map_type::navigator { m_map, bucket, position };
+               on_found(it);
+               return false;
+            }
+         }
+      } // the bucket is full or the key is in the overflow table
+      return insert_exclusive(key, std::move(value), on_found);
+   }
+
+   public:
+   striped_chaining_map(uint_fast8_t key_width = sizeof(key_type)*8, uint_fast8_t value_width = sizeof(value_type)*8)
+      : m_map(key_width, value_width) {
+      m_map.reserve(std::min<size_t>(key_width-1, separate_chaining::INITIAL_BUCKETS));
+   }
+
+   striped_chaining_map(const striped_chaining_map&) = delete;
+   striped_chaining_map& operator=(const striped_chaining_map&) = delete;
+
+   static constexpr size_t stripes() { return stripe_count; }
+
+   //! returns the maximum value of a key that can be stored
+   key_type max_key() const { return m_map.max_key(); }
+   value_type max_value() const { return m_map.max_value(); }
+   uint_fast8_t key_width() const { return m_map.key_width(); }
+   uint_fast8_t value_width() const { return m_map.value_width(); }
+
+   /**
+    * Looks up `key` and stores its value in `value`.
+    * Returns whether `key` is stored in the hash table.
+    */
+   bool find(const key_type& key, value_type& value) const {
+      std::shared_lock<std::shared_mutex> resize_lock(m_resize_mutex);
+      const auto [quotient, bucket] = m_map.m_hash.map(key, m_map.bucket_count_log2());
+      std::lock_guard<spinlock> lock(stripe_lock(bucket));
+      if(m_map.m_overflow.need_consult(bucket) && m_map.m_overflow.size() > 0) {
+         const size_t position = m_map.m_overflow.find(key);
+         if(position != static_cast<size_t>(-1ULL)) {
+            value = m_map.m_overflow[position];
+            return true;
+         }
+      }
+      const size_t position = m_map.locate(bucket, quotient);
+      if(position == static_cast<size_t>(-1ULL)) { return false; }
+      value = m_map.value_at(bucket, position);
+      return true;
+   }
+
+   //! @see std::set
+   size_type count(const key_type& key) const {
+      value_type value;
+      return find(key, value) ? 1 : 0;
+   }
+
+   /**
+    * Inserts `key` with `value` if `key` is not yet stored.
+    * Returns the value stored with `key` after the operation.
+    */
+   value_type find_or_insert(const key_type& key, value_type&& value) {
+      value_type stored = value;
+      insert(key, std::move(value), [&stored] (const auto& it) { stored = it.value(); });
+      return stored;
+   }
+
+   //! stores `value` with `key`, overwriting a possibly stored value
+   void assign(const key_type& key, const value_type& value) {
+      insert(key, value_type(value), [&value] (auto& it) { it = value; });
+   }
+
+   /**
+    * Inserts `key` with `value` if `key` is not yet stored.
+    * Otherwise, replaces the stored value `v` with `merge(v, value)`, e.g., `std::plus` for counting.
+    * Returns the value stored with `key` after the operation.
+    */
+   template<class merge_function>
+   value_type upsert(const key_type& key, const value_type& value, merge_function&& merge) {
+      value_type stored = value;
+      insert(key, value_type(value), [&stored, &value, &merge] (auto& it) {
+            stored = merge(it.value(), value);
+            it = stored;
+      });
+      return stored;
+   }
+
+   //! @see std::unordered_map
+   size_type erase(const key_type& key) {
+      {
+         std::shared_lock<std::shared_mutex> resize_lock(m_resize_mutex);
+         const auto [quotient, bucket] = m_map.m_hash.map(key, m_map.bucket_count_log2());
+         std::lock_guard<spinlock> lock(stripe_lock(bucket));
+         const size_t position = m_map.locate(bucket, quotient);
+         if(position != static_cast<size_t>(-1ULL)) {
+            m_map.erase_in_bucket(bucket, position);
+            m_elements.fetch_sub(1, std::memory_order_relaxed);
+            return 1;
+         }
+         if(!m_map.m_overflow.need_consult(bucket) || m_map.m_overflow.size() == 0) { return 0; }
+      } // the key may be stored in the overflow table
+      std::unique_lock<std::shared_mutex> lock(m_resize_mutex);
+      m_map.m_elements = m_elements.load(std::memory_order_relaxed);
+      const size_type erased = m_map.erase(key);
+      m_elements.store(m_map.size(), std::memory_order_relaxed);
+      return erased;
+   }
+
+   //! number of stored elements
+   size_t size() const { return m_elements.load(std::memory_order_relaxed); }
+
+   //! @see std::unordered_map
+   bool empty() const { return size() == 0; }
+
+   size_type bucket_count() const {
+      std::shared_lock<std::shared_mutex> lock(m_resize_mutex);
+      return m_map.bucket_count();
+   }
+
+   void reserve(const size_t reserve) {
+      std::unique_lock<std::shared_mutex> lock(m_resize_mutex);
+      m_map.m_elements = m_elements.load(std::memory_order_relaxed);
+      m_map.reserve(reserve);
+   }
+
+   void clear() {
+      std::unique_lock<std::shared_mutex> lock(m_resize_mutex);
+      m_map.clear();
+      m_elements.store(0, std::memory_order_relaxed);
+      m_map.reserve(std::min<size_t>(m_map.key_width()-1, separate_chaining::INITIAL_BUCKETS));
+   }
+
+   //! number of bytes the hash table uses
+   size_type size_in_bytes() const {
+      std::unique_lock<std::shared_mutex> lock(m_resize_mutex);
+      return sizeof(class_type) - sizeof(map_type) + m_map.size_in_bytes();
+   }
+
+   /**
+    * Gives access to the wrapped hash table for sequential post-processing (e.g., iteration or serialization).
+    * Must not be called while other threads operate on this object.
+    */
+   map_type& map() {
+      m_map.m_elements = m_elements.load(std::memory_order_relaxed);
+      return m_map;
+   }
+};
+
+}//ns separate_chaining
@@ -8,6 +8,9 @@
 
 #define COMMA ,
 
+//! the AVX-512 buckets are compiled in every x86-64 build, but can only be tested on a CPU supporting AVX-512
+#define SKIP_WITHOUT_AVX512 if(!avx512_supported()) { GTEST_SKIP() << "the CPU does not support AVX-512"; }
+
 using namespace separate_chaining;
 using bijective_hash = bijective_hash::Xorshift;
 
@@ -229,6 +232,41 @@ void test_map_random_large(T& map) {
    }
 }
 
+//! fills `map` with random elements and checks that its statistics are consistent with its contents
+template<class T>
+void test_map_stats(T& map) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   for(size_t i = 0; i < 10000; ++i) {
+      map[random_int<key_type>(map.max_key())] = random_int<value_type>(map.max_value());
+   }
+   const auto stats = map.stats();
+   ASSERT_EQ(stats.elements, map.size());
+   ASSERT_GT(stats.bucket_count, 0ULL);
+   size_t buckets = 0;
+   size_t elements = 0;
+   for(size_t size = 0; size < stats.bucket_size_histogram.size(); ++size) {
+      buckets += stats.bucket_size_histogram[size];
+      elements += size * stats.bucket_size_histogram[size];
+   }
+   ASSERT_EQ(buckets, stats.bucket_count);
+   ASSERT_EQ(elements, stats.bucket_elements());
+   ASSERT_EQ(stats.bucket_size_histogram[0], stats.empty_buckets);
+   ASSERT_EQ(stats.bucket_size_histogram.size(), stats.max_chain_length+1);
+   ASSERT_GE(stats.capacity, stats.bucket_elements());
+#ifdef NDEBUG // varwidth_bucket reports a different layout in debug mode
+   ASSERT_GE(stats.key_bytes*8, stats.bucket_elements()*stats.quotient_width);
+   ASSERT_GE(stats.value_bytes*8, stats.bucket_elements()*stats.value_width);
+#endif
+   ASSERT_GE(stats.average_chain_length(), 1.0);
+   ASSERT_EQ(stats.bytes(), stats.key_bytes + stats.value_bytes + stats.metadata_bytes);
+   const std::string json = stats.to_json();
+   ASSERT_EQ(json.front(), '{');
+   ASSERT_EQ(json.back(), '}');
+   ASSERT_NE(json.find("\"bucket_size_histogram\":["), std::string::npos);
+   ASSERT_NE(json.find("\"elements\":" + std::to_string(map.size())), std::string::npos);
+}
+
 
 
 
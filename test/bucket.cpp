@@ -6,3 +6,152 @@ TEST_SMALL_MAP(map_bucket_plain_arb_16,  bucket_table<plain_bucket<uint32_t> COM
 TEST_SMALL_MAP(map_bucket_var_arb_16,    bucket_table<varwidth_bucket<> COMMA plain_bucket<uint16_t> COMMA arbitrary_resize_bucket> map)
 TEST_SMALL_MAP(map_bucket_plain_16,  bucket_table<plain_bucket<uint32_t> COMMA plain_bucket<uint16_t> COMMA incremental_resize> map)
 TEST_SMALL_MAP(map_bucket_var_16,    bucket_table<varwidth_bucket<> COMMA plain_bucket<uint16_t> COMMA incremental_resize> map)
+
+TEST(map_bucket, stats) { 
+   bucket_table<varwidth_bucket<>, plain_bucket<uint16_t>, incremental_resize> map(20);
+   test_map_stats(map);
+   ASSERT_EQ(map.stats().bucket_count, 1ULL);
+}
+
+//! compares `find` of `bucket_type` with a linear scan for each bucket length up to three registers, such that the masked tail covers all of its lengths
+template<class bucket_type>
+void test_bucket_find() {
+   using storage_type = typename bucket_type::storage_type;
+   constexpr size_t max_length = 3*64/sizeof(storage_type) + 3;
+   std::vector<storage_type> plain(max_length);
+   bucket_type bucket;
+   bucket.initialize(max_length, sizeof(storage_type)*8);
+   for(size_t i = 0; i < max_length; ++i) {
+      plain[i] = static_cast<storage_type>(i+1);
+      bucket.write(i, plain[i], sizeof(storage_type)*8);
+   }
+   for(size_t length = 0; length <= max_length; ++length) {
+      for(size_t i = 0; i < max_length; ++i) {
+         ASSERT_EQ(bucket.find(plain[i], length, sizeof(storage_type)*8), i < length ? i : -1ULL);
+      }
+      ASSERT_EQ(bucket.find(0, length, sizeof(storage_type)*8), -1ULL);
+   }
+   bucket.erase(1, max_length, sizeof(storage_type)*8);
+   ASSERT_EQ(bucket.read(0, sizeof(storage_type)*8), plain[0]);
+   ASSERT_EQ(bucket.read(1, sizeof(storage_type)*8), plain[2]);
+   ASSERT_EQ(bucket.find(plain[max_length-1], max_length-1, sizeof(storage_type)*8), max_length-2);
+}
+
+//! compares the search kernel of `level` with `find_scalar` on arrays with one or two occurrences of the key at each position
+template<class storage_type>
+void test_kernel(const simd::isa level) {
+   const simd::find_function<storage_type> kernel = simd::find_kernel<storage_type>(level);
+   constexpr size_t max_length = 3*64/sizeof(storage_type) + 3;
+   std::vector<storage_type> data(max_length);
+   for(size_t i = 0; i < max_length; ++i) { data[i] = static_cast<storage_type>(i+1); }
+   for(size_t length = 0; length <= max_length; ++length) {
+      for(size_t i = 0; i < max_length; ++i) {
+         ASSERT_EQ(kernel(data.data(), length, data[i]), simd::find_scalar(data.data(), length, data[i])) << simd::isa_name(level);
+      }
+      // a key that is not stored
+      ASSERT_EQ(kernel(data.data(), length, static_cast<storage_type>(0)), -1ULL) << simd::isa_name(level);
+   }
+   // duplicates: the first occurrence is returned
+   for(size_t i = 0; i+1 < max_length; ++i) {
+      std::vector<storage_type> copy = data;
+      copy[max_length-1] = copy[i];
+      ASSERT_EQ(kernel(copy.data(), max_length, copy[i]), i) << simd::isa_name(level);
+   }
+   // the SWAR kernel must not report a lane above a zero lane whose borrow sets its high bit
+   std::vector<storage_type> borrow(max_length, static_cast<storage_type>(1));
+   for(size_t i = 0; i < max_length; ++i) {
+      borrow[i] = 0;
+      ASSERT_EQ(kernel(borrow.data(), max_length, static_cast<storage_type>(1)), i == 0 ? 1 : 0) << simd::isa_name(level);
+      ASSERT_EQ(kernel(borrow.data(), max_length, static_cast<storage_type>(0)), i) << simd::isa_name(level);
+      borrow[i] = 1;
+   }
+}
+
+TEST(simd, kernels) {
+   for(const simd::isa level : { simd::isa::scalar, simd::isa::swar, simd::isa::avx2, simd::isa::avx512 }) {
+      if(!simd::supported(level)) { continue; }
+      test_kernel<uint8_t>(level);
+      test_kernel<uint16_t>(level);
+      test_kernel<uint32_t>(level);
+      test_kernel<uint64_t>(level);
+   }
+}
+
+TEST(plain_bucket, find) {
+   test_bucket_find<plain_bucket<uint8_t>>();
+   test_bucket_find<plain_bucket<uint16_t>>();
+   test_bucket_find<plain_bucket<uint32_t>>();
+   test_bucket_find<plain_bucket<uint64_t>>();
+   plain_bucket<int8_t> bucket; // negative keys
+   bucket.initialize(20, 8);
+   for(size_t i = 0; i < 20; ++i) { bucket.write(i, -static_cast<int8_t>(i)-1, 8); }
+   for(size_t i = 0; i < 20; ++i) { ASSERT_EQ(bucket.find(-static_cast<int8_t>(i)-1, 20, 8), i); }
+   ASSERT_EQ(bucket.find(0, 20, 8), -1ULL);
+}
+
+TEST(dispatch_bucket, find) {
+   ASSERT_TRUE(simd::supported(simd::best_isa()));
+   test_bucket_find<dispatch_bucket<uint8_t>>();
+   test_bucket_find<dispatch_bucket<uint16_t>>();
+   test_bucket_find<dispatch_bucket<uint32_t>>();
+   test_bucket_find<dispatch_bucket<uint64_t>>();
+}
+
+//! compares `varwidth_bucket::find` with reading each field, for all widths the packed search kernels handle and lengths covering several iterations with all tails
+TEST(varwidth_bucket, find) {
+   constexpr size_t max_length = 40;
+   for(uint_fast8_t width = 1; width <= 40; ++width) {
+      const uint64_t max_value = (-1ULL) >> (64-width);
+      for(size_t length = 0; length <= max_length; ++length) {
+         varwidth_bucket<> bucket;
+         bucket.initialize(std::max<size_t>(length, 1), width);
+         std::vector<uint64_t> values(length);
+         for(size_t i = 0; i < length; ++i) {
+            values[i] = random_int<uint64_t>(std::min<uint64_t>(max_value, length)+1); // small values give duplicates
+            bucket.write(i, values[i], width);
+         }
+         for(uint64_t key = 0; key <= std::min<uint64_t>(max_value, length+1); ++key) {
+            const size_t expected = std::find(values.begin(), values.end(), key) - values.begin();
+            ASSERT_EQ(bucket.find(key, length, width), expected == length ? -1ULL : expected) << "width " << static_cast<size_t>(width) << " length " << length;
+         }
+         if(length > 0) {
+            ASSERT_EQ(bucket.find(values.back(), length, width), static_cast<size_t>(std::find(values.begin(), values.end(), values.back()) - values.begin()));
+            if(width < 64) { ASSERT_EQ(bucket.find(max_value+1, length, width), -1ULL); }
+         }
+      }
+   }
+}
+
+//! compares `move_bits` with moving bit by bit through a copy, for overlapping ranges in both directions at all offsets within a byte
+TEST(move_bits, overlap) {
+   constexpr size_t bytes = 48;
+   for(size_t round = 0; round < 20000; ++round) {
+      std::vector<uint8_t> data(bytes);
+      for(uint8_t& byte : data) { byte = random_int<uint32_t>(256); }
+      const size_t bits = random_int<size_t>(bytes*8);
+      const size_t to = random_int<size_t>(bytes*8 - bits + 1);
+      const size_t from = round % 2 == 0 ? random_int<size_t>(bytes*8 - bits + 1) : std::min<size_t>(to + round % 17, bytes*8 - bits);
+      std::vector<uint8_t> expected = data;
+      for(size_t i = 0; i < bits; ++i) {
+         const size_t bit = (data[(from+i)/8] >> ((from+i)%8)) & 1;
+         expected[(to+i)/8] = (expected[(to+i)/8] & ~(1U << ((to+i)%8))) | (bit << ((to+i)%8));
+      }
+      move_bits(data.data(), to, from, bits);
+      ASSERT_EQ(data, expected) << "to " << to << " from " << from << " bits " << bits;
+   }
+}
+
+TEST_SMALL_MAP(map_bucket_dispatch_8, bucket_table<dispatch_bucket<uint8_t> COMMA plain_bucket<uint16_t> COMMA incremental_resize> map)
+
+#ifdef SEPARATE_X86_TARGETS
+
+TEST(avx512_bucket, find) {
+   SKIP_WITHOUT_AVX512
+   test_bucket_find<avx512_bucket<uint8_t>>();
+   test_bucket_find<avx512_bucket<uint16_t>>();
+   test_bucket_find<avx512_bucket<uint32_t>>();
+   test_bucket_find<avx512_bucket<uint64_t>>();
+}
+
+TEST_SMALL_MAP(map_bucket_avx512_16, SKIP_WITHOUT_AVX512 bucket_table<avx512_bucket<uint16_t> COMMA plain_bucket<uint16_t> COMMA incremental_resize> map)
+#endif//SEPARATE_X86_TARGETS
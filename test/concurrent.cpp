@@ -0,0 +1,259 @@
+#include "base.hpp"
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <separate/separate_chaining_table.hpp>
+#include <separate/sharded_chaining_map.hpp>
+#include <separate/striped_chaining_map.hpp>
+#include <separate/group_chaining.hpp>
+
+template<class T>
+void test_concurrent_random(T& map) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   const uint64_t max_key = map.max_key();
+   const uint64_t max_value = map.max_value();
+   for(size_t reps = 0; reps < 100; ++reps) {
+      map.clear();
+      std::map<key_type, value_type> rev;
+      for(size_t i = 0; i < 1000; ++i) {
+         const key_type key = random_int<key_type>(max_key);
+         const value_type val = random_int<value_type>(max_value);
+         if(rev.find(key) == rev.end()) { rev[key] = val; }
+         ASSERT_EQ(map.find_or_insert(key, value_type(val)), rev[key]);
+         ASSERT_EQ(map.size(), rev.size());
+      }
+      for(size_t i = 0; i < 100; ++i) {
+         const key_type key = random_int<key_type>(max_key);
+         ASSERT_EQ(map.erase(key), rev.erase(key));
+         ASSERT_EQ(map.size(), rev.size());
+      }
+      for(auto el : rev) {
+         value_type value;
+         ASSERT_TRUE(map.find(el.first, value));
+         ASSERT_EQ(value, el.second);
+      }
+      for(size_t i = 0; i < 100; ++i) {
+         const key_type key = random_int<key_type>(max_key);
+         ASSERT_EQ(map.count(key), rev.count(key));
+      }
+   }
+}
+
+template<class T>
+void test_concurrent_threads(T& map, const size_t threads) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   constexpr size_t elements_per_thread = 100000;
+   std::vector<std::thread> workers;
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&map, t] () {
+         for(size_t i = 0; i < elements_per_thread; ++i) {
+            const key_type key = t*elements_per_thread + i;
+            map.find_or_insert(key, static_cast<value_type>(key*3));
+         }
+         for(size_t i = 0; i < elements_per_thread; i += 2) { // erase every second own key
+            map.erase(t*elements_per_thread + i);
+         }
+      });
+   }
+   // concurrent readers on keys that may or may not be inserted yet
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&map, threads] () {
+         for(size_t i = 0; i < elements_per_thread; ++i) {
+            const key_type key = random_int<key_type>(threads*elements_per_thread);
+            value_type value;
+            if(map.find(key, value)) { ASSERT_EQ(value, static_cast<value_type>(key*3)); }
+         }
+      });
+   }
+   for(auto& worker : workers) { worker.join(); }
+
+   ASSERT_EQ(map.size(), threads*elements_per_thread/2);
+   for(size_t i = 0; i < threads*elements_per_thread; ++i) {
+      value_type value;
+      ASSERT_EQ(map.find(i, value), (i % 2) == 1);
+      if(i % 2 == 1) { ASSERT_EQ(value, static_cast<value_type>(i*3)); }
+   }
+}
+
+template<class T>
+void test_sharded_serialize(T& map) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   for(size_t i = 0; i < 10000; ++i) {
+      map.assign(random_int<key_type>(map.max_key()), random_int<value_type>(map.max_value()));
+   }
+   std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+   map.serialize(ss);
+   T map2(map.key_width(), map.value_width());
+   ss.seekg(0);
+   map2.deserialize(ss);
+   ASSERT_EQ(map.size(), map2.size());
+   for(size_t shard = 0; shard < T::shards(); ++shard) {
+      ASSERT_EQ(map.shard_size(shard), map2.shard_size(shard));
+   }
+   for(size_t i = 0; i < 10000; ++i) {
+      const key_type key = random_int<key_type>(map.max_key());
+      value_type value, value2;
+      const bool found = map.find(key, value);
+      ASSERT_EQ(found, map2.find(key, value2));
+      if(found) { ASSERT_EQ(value, value2); }
+   }
+}
+
+using sharded_plain = sharded_chaining_map<separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>>, 16>;
+using sharded_var_Xor = sharded_chaining_map<separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<uint64_t>, arbitrary_resize, array_overflow>>;
+using sharded_single = sharded_chaining_map<separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<uint64_t>>, 1>;
+
+TEST(sharded, random_plain) { sharded_plain map; test_concurrent_random(map); }
+TEST(sharded, random_var_Xor) { sharded_var_Xor map(24); test_concurrent_random(map); }
+TEST(sharded, random_single) { sharded_single map(24); test_concurrent_random(map); }
+
+TEST(sharded, threads_plain) { sharded_plain map; test_concurrent_threads(map, 8); }
+TEST(sharded, threads_var_Xor) { sharded_var_Xor map(32); test_concurrent_threads(map, 8); }
+TEST(sharded, threads_single) { sharded_single map(32); test_concurrent_threads(map, 4); }
+
+TEST(sharded, serialize_plain) { sharded_plain map; test_sharded_serialize(map); }
+TEST(sharded, serialize_var_Xor) { sharded_var_Xor map(40); test_sharded_serialize(map); }
+
+TEST(sharded, routing) {
+   sharded_var_Xor map(32);
+   for(size_t i = 0; i < 100000; ++i) { map.assign(i, i); }
+   for(size_t shard = 0; shard < sharded_var_Xor::shards(); ++shard) { // every shard receives a fair share
+      ASSERT_GT(map.shard_size(shard), 100000 / sharded_var_Xor::shards() / 2);
+   }
+}
+
+template<class T>
+void test_concurrent_upsert(T& map, const size_t threads) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   constexpr size_t distinct_keys = 50000;
+   constexpr size_t increments = 4;
+   std::vector<std::thread> workers;
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&map] () {
+         for(size_t r = 0; r < increments; ++r) {
+            for(key_type key = 0; key < distinct_keys; ++key) {
+               map.upsert(key, 1, std::plus<value_type>());
+            }
+         }
+      });
+   }
+   for(auto& worker : workers) { worker.join(); }
+   ASSERT_EQ(map.size(), distinct_keys);
+   for(key_type key = 0; key < distinct_keys; ++key) {
+      value_type value;
+      ASSERT_TRUE(map.find(key, value));
+      ASSERT_EQ(value, threads*increments);
+   }
+}
+
+using striped_plain = striped_chaining_map<separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>>, 256>;
+using striped_var_Xor = striped_chaining_map<separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<uint64_t>, arbitrary_resize>>;
+using striped_var_Xor_OverArray = striped_chaining_map<separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<uint64_t>, incremental_resize, array_overflow>>;
+
+TEST(striped, random_plain) { striped_plain map; test_concurrent_random(map); }
+TEST(striped, random_var_Xor) { striped_var_Xor map(24); test_concurrent_random(map); }
+TEST(striped, random_var_Xor_OverArray) { striped_var_Xor_OverArray map(24); test_concurrent_random(map); }
+
+TEST(striped, threads_plain) { striped_plain map; test_concurrent_threads(map, 8); }
+TEST(striped, threads_var_Xor) { striped_var_Xor map(32); test_concurrent_threads(map, 8); }
+TEST(striped, threads_var_Xor_OverArray) { striped_var_Xor_OverArray map(32); test_concurrent_threads(map, 8); }
+
+TEST(striped, upsert) { striped_plain map; test_concurrent_upsert(map, 8); }
+
+//! insertions and erasures in different stripes update the reallocation counters of `counting_instrumentation` concurrently
+TEST(striped, threads_counting) {
+   striped_chaining_map<separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, arbitrary_resize, dummy_overflow, malloc_allocator, ordered_erase, counting_instrumentation>, 256> map;
+   test_concurrent_threads(map, 8);
+   const probe_counters counters = map.map().counters();
+   ASSERT_GT(counters.bucket_resizes, 0U);
+   ASSERT_GT(counters.bytes_moved, 0U);
+}
+TEST(sharded, upsert) { sharded_plain map; test_concurrent_upsert(map, 8); }
+
+/**
+ * Several threads query a shared const table without any locks.
+ * Run with ThreadSanitizer (option SEPARATE_TSAN) to check that the const paths are race-free.
+ */
+template<class T>
+void test_const_readers(T& map, const size_t threads) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   constexpr size_t elements = 20000;
+   std::map<key_type, value_type> rev;
+   for(size_t i = 0; i < elements; ++i) {
+      const key_type key = random_int<key_type>(map.max_key());
+      const value_type value = random_int<value_type>(map.max_value());
+      map[key] = rev[key] = value;
+   }
+   const T& const_map = map;
+   std::vector<std::thread> workers;
+   std::vector<size_t> sums(threads);
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&const_map, &rev, &sums, t] () {
+         for(auto el : rev) {
+            const auto it = const_map.find(el.first);
+            ASSERT_NE(it, const_map.cend());
+            ASSERT_EQ(it->second, el.second);
+            ASSERT_EQ(const_map.count(el.first), 1ULL);
+            ASSERT_EQ(const_map.locate(el.first).first, it.bucket());
+         }
+         for(size_t i = 0; i < elements; ++i) {
+            const key_type key = random_int<key_type>(const_map.max_key());
+            ASSERT_EQ(const_map.count(key), rev.count(key));
+         }
+         for(auto it = const_map.cbegin_nav(); it != const_map.cend_nav(); ++it) {
+            sums[t] += it.key();
+         }
+      });
+   }
+   for(auto& worker : workers) { worker.join(); }
+   const size_t sum = std::accumulate(rev.begin(), rev.end(), size_t(0), [] (size_t s, const auto& el) { return s + el.first; });
+   for(size_t t = 0; t < threads; ++t) {
+      ASSERT_EQ(sums[t], sum);
+   }
+}
+
+TEST(const_readers, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_const_readers(map, 8);
+}
+TEST(const_readers, var_Xor_OverArray) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, array_overflow> map(32);
+   test_const_readers(map, 8);
+}
+TEST(const_readers, var_Xor_OverMap) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, map_overflow> map(32);
+   test_const_readers(map, 8);
+}
+TEST(const_readers, incremental) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   map.incremental_rehash(1);
+   test_const_readers(map, 8);
+}
+TEST(const_readers, group) {
+   group::group_chaining_table<> map(32, 32);
+   test_const_readers(map, 8);
+}
+//! the lookup counters of `counting_instrumentation` are updated by concurrent const lookups without losing increments
+TEST(const_readers, counting) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, arbitrary_resize, dummy_overflow, malloc_allocator, ordered_erase, counting_instrumentation> map;
+   test_const_readers(map, 8);
+   map.reset_counters();
+   const auto& const_map = map;
+   constexpr size_t threads = 8;
+   constexpr size_t lookups = 10000;
+   std::vector<std::thread> workers;
+   for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&const_map] () {
+         for(size_t i = 0; i < lookups; ++i) { const_map.count(random_int<uint32_t>(const_map.max_key())); }
+      });
+   }
+   for(auto& worker : workers) { worker.join(); }
+   const probe_counters counters = map.counters();
+   ASSERT_EQ(counters.locates, threads*lookups);
+   ASSERT_EQ(counters.hits + counters.misses, threads*lookups);
+}
@@ -42,3 +42,27 @@ TEST(map_group, out) {
 TEST_SMALL_MAP(map_group, group::group_chaining_table<> map(32,32))
 TEST_SMALL_MAP(map_group_middle, group::group_chaining_table<> map(10,13))
 TEST_MAP_FULL(map_group_low, group::group_chaining_table<> map(7,3))
+TEST_MAP_FULL(map_group_hashed_overflow, group::group_chaining_table<xorshift_hash<> COMMA hashed_overflow<uint64_t COMMA uint64_t>> map(32,16))
+
+TEST(map_group, stats) { 
+   group::group_chaining_table<> map(32,16);
+   test_map_stats(map);
+   ASSERT_EQ(map.stats().bucket_count, map.bucket_count());
+}
+
+TEST(map_group, instrumentation) { 
+   group::group_chaining_table<xorshift_hash<>, dummy_overflow<uint64_t,uint64_t>, counting_instrumentation> map(32,16);
+   std::vector<uint64_t> keys;
+   for(size_t i = 0; i < 10000; ++i) { 
+      keys.push_back(random_int<uint64_t>(map.max_key()));
+      map[keys.back()] = i;
+   }
+   ASSERT_GT(map.counters().rehashes, 0ULL);
+   ASSERT_GT(map.counters().bucket_resizes, 0ULL);
+   map.reset_counters();
+   for(const uint64_t key : keys) { ASSERT_NE(map.find(key), map.cend()); }
+   const probe_counters counters = map.counters();
+   ASSERT_EQ(counters.locates, keys.size());
+   ASSERT_EQ(counters.hits, keys.size());
+   ASSERT_GE(counters.comparisons, keys.size());
+}
@@ -0,0 +1,159 @@
+#include "base.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <separate/separate_chaining_table.hpp>
+#include <separate/mapped_chaining_table.hpp>
+#include <separate/frozen_chaining_table.hpp>
+
+//! checks that the read-only table `view` answers all queries like `map`
+template<class T, class V>
+void test_view_equal(const T& map, const V& view) {
+   ASSERT_EQ(view.size(), map.size());
+   size_t elements = 0;
+   for(auto it = view.cbegin_nav(); it != view.cend_nav(); ++it) {
+      const auto original = map.find(it.key());
+      ASSERT_NE(original, map.cend());
+      ASSERT_EQ(original->second, it.value());
+      ++elements;
+   }
+   ASSERT_EQ(elements, map.size());
+   for(auto it = map.cbegin(); it != map.cend(); ++it) {
+      const auto found = view.find(it->first);
+      ASSERT_NE(found, view.cend());
+      ASSERT_EQ(found->first, it->first);
+      ASSERT_EQ(found->second, it->second);
+   }
+   for(size_t i = 0; i < 1000; ++i) {
+      const auto key = random_int<typename T::key_type>(map.max_key());
+      ASSERT_EQ(view.count(key), map.count(key));
+   }
+}
+
+//! writes `map` to a buffer and checks that a `mapped_chaining_table` and a `frozen_chaining_table` on it answer all queries like `map`
+template<class T>
+void test_mapped_equal(const T& map) {
+   std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+   write_mapped(map, ss);
+   const std::string str = ss.str();
+   std::vector<uint64_t> buffer(ceil_div<size_t>(str.size(), sizeof(uint64_t)));
+   std::memcpy(buffer.data(), str.data(), str.size());
+
+   mapped_chaining_table<T> mapped(reinterpret_cast<const char*>(buffer.data()), str.size());
+   ASSERT_EQ(mapped.size_in_bytes(), str.size());
+   test_view_equal(map, mapped);
+
+   const frozen_chaining_table<T> frozen = freeze(map);
+   test_view_equal(map, frozen);
+   std::stringstream frozen_ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+   frozen.serialize(frozen_ss);
+   ASSERT_EQ(frozen_ss.str(), str);
+}
+
+template<class T>
+void test_mapped_random(T& map) {
+   for(size_t i = 0; i < 100000; ++i) {
+      map[random_int<typename T::key_type>(map.max_key())] = random_int<typename T::value_type>(map.max_value());
+   }
+   test_mapped_equal(map);
+}
+
+TEST(mapped, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_mapped_random(map);
+}
+TEST(mapped, var_Xor) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<>, arbitrary_resize> map(40);
+   test_mapped_random(map);
+}
+TEST(mapped, var_Xor_narrow_values) {
+   separate_chaining_map<varwidth_bucket<>, varwidth_bucket<>, xorshift_hash<>> map(28, 7);
+   test_mapped_random(map);
+}
+TEST(mapped, empty) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_mapped_equal(map);
+}
+TEST(mapped, set) {
+   separate_chaining_set<varwidth_bucket<>, xorshift_hash<>> set(32);
+   for(size_t i = 0; i < 10000; ++i) { set.find_or_insert(random_int<uint64_t>(set.max_key()), true); }
+   std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+   write_mapped(set, ss);
+   const std::string str = ss.str();
+   std::vector<uint64_t> buffer(ceil_div<size_t>(str.size(), sizeof(uint64_t)));
+   std::memcpy(buffer.data(), str.data(), str.size());
+   mapped_chaining_table<decltype(set)> mapped(reinterpret_cast<const char*>(buffer.data()), str.size());
+   ASSERT_EQ(mapped.size(), set.size());
+   ASSERT_EQ(mapped.value_width(), 0);
+   ASSERT_EQ(mapped.max_value(), 0ULL);
+   ASSERT_EQ(mapped.max_key(), set.max_key());
+   for(auto it = set.cbegin_nav(); it != set.cend_nav(); ++it) { ASSERT_EQ(mapped.count(it.key()), 1ULL); }
+}
+
+//! maps all keys to the same bucket such that the overflow table fills up
+struct constant_hash {
+   uint64_t operator()(const uint64_t&) const { return 0; }
+};
+
+TEST(mapped, overflow) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, constant_hash>, incremental_resize, array_overflow> map;
+   for(uint32_t key = 0; key < 300; ++key) { map[key*7] = key; }
+   ASSERT_GT(map.m_overflow.size(), 0ULL);
+   test_mapped_equal(map);
+}
+
+TEST(mapped, rehash_pending) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   map.incremental_rehash(1);
+   for(size_t i = 0; i < 100000 && !map.rehash_pending(); ++i) { map[i] = i; }
+   ASSERT_TRUE(map.rehash_pending());
+   std::stringstream ss;
+   ASSERT_THROW(write_mapped(map, ss), std::runtime_error);
+   map.finish_rehash();
+   test_mapped_equal(map);
+}
+
+TEST(mapped, file) {
+   using map_type = separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>>;
+   map_type map(32);
+   for(size_t i = 0; i < 10000; ++i) { map[random_int<uint64_t>(map.max_key())] = i; }
+   std::string filename = ::testing::TempDir() + "separate_mapped_XXXXXX";
+   const int fd = mkstemp(filename.data()); // creates the file, such that no other process can take its name
+   ASSERT_NE(fd, -1);
+   close(fd);
+   {
+      std::ofstream os(filename, std::ios::binary);
+      write_mapped(map, os);
+   }
+   {
+      mapped_chaining_table<map_type> mapped(filename);
+      ASSERT_EQ(mapped.size(), map.size());
+      for(auto it = map.cbegin(); it != map.cend(); ++it) {
+         ASSERT_EQ(mapped.find(it->first)->second, it->second);
+      }
+   }
+   std::remove(filename.c_str());
+   ASSERT_THROW(mapped_chaining_table<map_type> missing(filename), std::runtime_error);
+}
+
+TEST(mapped, corrupt) {
+   using map_type = separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>>;
+   std::vector<uint64_t> buffer(32, 0);
+   ASSERT_THROW((mapped_chaining_table<map_type>(reinterpret_cast<const char*>(buffer.data()), buffer.size()*sizeof(uint64_t))), std::runtime_error);
+   ASSERT_THROW((mapped_chaining_table<map_type>(reinterpret_cast<const char*>(buffer.data()), 8)), std::runtime_error);
+}
+
+TEST(frozen, smaller) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize> map(32);
+   for(size_t i = 0; i < 100000; ++i) { map[random_int<uint64_t>(map.max_key())] = i; }
+   const auto frozen = freeze(map);
+   ASSERT_LT(frozen.size_in_bytes(), map.size_in_bytes());
+   const size_t elements = map.size();
+   map.clear(); // the frozen table does not depend on the original
+   ASSERT_EQ(frozen.size(), elements);
+   size_t iterated = 0;
+   for(auto it = frozen.cbegin(); it != frozen.cend(); ++it, ++iterated) { ASSERT_EQ(frozen.find(it->first)->second, it->second); }
+   ASSERT_EQ(iterated, elements);
+}
@@ -1,6 +1,7 @@
 #include "base.hpp"
 #include <separate/separate_chaining_table.hpp>
 #include <separate/bijective_hash.hpp>
+#include <separate/compact_chaining_map.hpp>
 
 
 TEST(map, quotienting) {
@@ -17,6 +18,8 @@ TEST_MAP_FULL(map_var_var_low,  separate_chaining_map<varwidth_bucket<> COMMA va
 
 TEST_MAP_FULL(map_var_Xor_64_OverMap, separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<> COMMA incremental_resize COMMA map_overflow> map(64))
 TEST_MAP_FULL(map_var_Xor_64_OverArray, separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<> COMMA incremental_resize COMMA array_overflow> map(64))
+TEST_MAP_FULL(map_var_Xor_64_OverHashed, separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<> COMMA incremental_resize COMMA hashed_overflow> map(64))
+TEST_MAP_FULL(map_plain_Xor_OverHashed, separate_chaining_map<plain_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<uint32_t> COMMA arbitrary_resize COMMA hashed_overflow> map(32))
 
 
 TEST_MAP_FULL(map_var_arb_16,  separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint16_t> COMMA hash_mapping_adapter<uint64_t COMMA SplitMix> COMMA arbitrary_resize> map)
@@ -42,6 +45,28 @@ TEST_MAP_FULL(map_avx2_64_Xor, separate_chaining_map<avx2_bucket<uint64_t> COMMA
 TEST_MAP_FULL(map_avx2_16_arb_16,  separate_chaining_map<avx2_bucket<uint16_t> COMMA plain_bucket<uint16_t> COMMA hash_mapping_adapter<uint16_t COMMA SplitMix> COMMA arbitrary_resize> map)
 #endif//__AVX2__
 
+TEST_MAP_FULL(map_dispatch_8_16,  separate_chaining_map<dispatch_bucket<uint8_t> COMMA plain_bucket<uint16_t> COMMA hash_mapping_adapter<uint8_t COMMA SplitMix> COMMA incremental_resize> map)
+TEST_MAP_FULL(map_dispatch_32_Xor, separate_chaining_map<dispatch_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<uint32_t> COMMA incremental_resize> map(32))
+TEST_MAP_FULL(map_dispatch_64_32,  separate_chaining_map<dispatch_bucket<uint64_t> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint64_t COMMA SplitMix> COMMA arbitrary_resize> map)
+
+#ifdef SEPARATE_X86_TARGETS
+TEST_MAP_FULL(map_avx512_8_16,  SKIP_WITHOUT_AVX512 separate_chaining_map<avx512_bucket<uint8_t> COMMA plain_bucket<uint16_t> COMMA hash_mapping_adapter<uint8_t COMMA SplitMix> COMMA incremental_resize> map)
+TEST_MAP_FULL(map_avx512_16_16,  SKIP_WITHOUT_AVX512 separate_chaining_map<avx512_bucket<uint16_t> COMMA plain_bucket<uint16_t> COMMA hash_mapping_adapter<uint16_t COMMA SplitMix> COMMA incremental_resize> map)
+TEST_MAP_FULL(map_avx512_32_Xor, SKIP_WITHOUT_AVX512 separate_chaining_map<avx512_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<uint32_t> COMMA incremental_resize> map(32))
+TEST_MAP_FULL(map_avx512_64_32,  SKIP_WITHOUT_AVX512 separate_chaining_map<avx512_bucket<uint64_t> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint64_t COMMA SplitMix> COMMA arbitrary_resize> map)
+TEST_MAP_FULL(map_avx512_slab,  SKIP_WITHOUT_AVX512 separate_chaining_map<avx512_bucket<uint16_t COMMA slab_allocator> COMMA plain_bucket<uint16_t COMMA slab_allocator> COMMA hash_mapping_adapter<uint16_t COMMA SplitMix> COMMA incremental_resize COMMA dummy_overflow COMMA slab_allocator> map)
+#endif//SEPARATE_X86_TARGETS
+
+TEST_MAP_FULL(map_plain_incremental,  separate_chaining_map<plain_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize> map; map.incremental_rehash(1))
+TEST_MAP_FULL(map_var_Xor_incremental, separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<uint64_t> COMMA arbitrary_resize> map(32); map.incremental_rehash(4))
+
+TEST_MAP_FULL(map_plain_slab,  separate_chaining_map<plain_bucket<uint32_t COMMA slab_allocator> COMMA plain_bucket<uint32_t COMMA slab_allocator> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize COMMA dummy_overflow COMMA slab_allocator> map)
+TEST_MAP_FULL(map_var_Xor_slab, separate_chaining_map<varwidth_bucket<uint8_t COMMA slab_allocator> COMMA plain_bucket<uint16_t COMMA slab_allocator> COMMA xorshift_hash<uint64_t> COMMA arbitrary_resize COMMA array_overflow COMMA slab_allocator> map(32))
+#ifdef __AVX2__
+TEST_MAP_FULL(map_avx2_slab,  separate_chaining_map<avx2_bucket<uint16_t COMMA slab_allocator> COMMA plain_bucket<uint16_t COMMA slab_allocator> COMMA hash_mapping_adapter<uint16_t COMMA SplitMix> COMMA incremental_resize COMMA dummy_overflow COMMA slab_allocator> map)
+#endif//__AVX2__
+TEST_MAP_FULL(map_class_slab,  separate_chaining_map<class_bucket<uint32_t> COMMA plain_bucket<uint32_t COMMA slab_allocator> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize COMMA dummy_overflow COMMA slab_allocator> map)
+
 TEST_MAP_FULL(map_plain_class32,  separate_chaining_map<class_bucket<uint32_t> COMMA class_bucket<uint32_t> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize> map)
 
 
@@ -50,6 +75,10 @@ TEST_MAP_FULL(map_var_16,  separate_chaining_map<varwidth_bucket<> COMMA plain_b
 TEST_MAP_FULL(map_var_32,  separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint64_t COMMA SplitMix> COMMA incremental_resize> map)
 TEST_MAP_FULL(map_var_Xor, separate_chaining_map<varwidth_bucket<> COMMA plain_bucket<uint32_t> COMMA xorshift_hash<uint64_t> COMMA incremental_resize> map(32))
 
+TEST_MAP_FULL(map_plain_unordered,  separate_chaining_map<plain_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize COMMA dummy_overflow COMMA malloc_allocator COMMA unordered_erase> map)
+TEST_MAP_FULL(map_var_Xor_unordered, separate_chaining_map<varwidth_bucket<> COMMA varwidth_bucket<> COMMA xorshift_hash<uint64_t> COMMA arbitrary_resize COMMA dummy_overflow COMMA malloc_allocator COMMA unordered_erase> map(32, 20); map.incremental_rehash(4))
+TEST_MAP(compact_map_unordered, compact_chaining_map<xorshift_hash<> COMMA uint8_t COMMA unordered_erase> map(32,16))
+
 
 
 TEST_SMALL_MAP(map_plain_small32,  separate_chaining_map<plain_bucket<uint32_t> COMMA plain_bucket<uint32_t> COMMA hash_mapping_adapter<uint32_t COMMA SplitMix> COMMA incremental_resize> map)
@@ -77,6 +106,756 @@ TEST(separate_chaining_map, step) {
 }
 
 
+template<class hash_mapping_type>
+void test_hash_split(const uint_fast8_t key_width) {
+   using key_type = typename hash_mapping_type::key_type;
+   hash_mapping_type hash(key_width);
+   for(uint_fast8_t table_buckets = 1; table_buckets+1 < key_width && table_buckets < 20; ++table_buckets) {
+      for(size_t i = 0; i < 1000; ++i) {
+	 const key_type key = random_int<key_type>(-1ULL >> (64-key_width));
+	 const auto [quotient, bucket] = hash.map(key, table_buckets);
+	 ASSERT_EQ(hash.split(quotient, bucket, table_buckets), hash.map(key, table_buckets+1));
+      }
+   }
+}
+
+TEST(hash, split) {
+   test_hash_split<xorshift_hash<uint32_t>>(32);
+   test_hash_split<xorshift_hash<uint64_t>>(27);
+   test_hash_split<hash_mapping_adapter<uint32_t, SplitMix>>(32);
+}
+
+template<class T>
+void test_map_batch(T& map) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   const uint64_t max_key = map.max_key();
+   const uint64_t max_value = map.max_value();
+   constexpr size_t NUM_QUERIES = 1000;
+
+   std::vector<key_type> keys(NUM_QUERIES);
+   std::vector<std::pair<size_t,size_t>> locations(NUM_QUERIES);
+   for(size_t i = 0; i < NUM_QUERIES; ++i) { keys[i] = random_int<key_type>(max_key); }
+   ASSERT_EQ(map.count_batch(keys.data(), NUM_QUERIES), 0ULL);
+
+   for(size_t reps = 0; reps < 10; ++reps) {
+      for(size_t i = 0; i < 1000; ++i) {
+	 map[random_int<key_type>(max_key)] = random_int<value_type>(max_value);
+      }
+      for(size_t i = 0; i < NUM_QUERIES; ++i) { // mix of present and (mostly) absent keys
+	 keys[i] = (i % 2) ? random_int<key_type>(max_key) : map.begin_nav().key();
+	 if(i % 3 == 0) { map.erase(map.begin_nav()); }
+      }
+      const size_t found = map.find_batch(keys.data(), NUM_QUERIES, locations.data());
+      ASSERT_EQ(map.count_batch(keys.data(), NUM_QUERIES), found);
+      size_t expected = 0;
+      for(size_t i = 0; i < NUM_QUERIES; ++i) {
+	 const auto it = map.find(keys[i]);
+	 if(it == map.cend()) {
+	    ASSERT_EQ(locations[i].second, static_cast<size_t>(-1ULL));
+	    continue;
+	 }
+	 ++expected;
+	 ASSERT_EQ(locations[i], map.locate(keys[i]));
+	 ASSERT_EQ(map.value_at(locations[i].first, locations[i].second), it->second);
+      }
+      ASSERT_EQ(found, expected);
+   }
+}
+
+TEST(batch, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize> map;
+   test_map_batch(map);
+}
+TEST(batch, plain_Xor) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, xorshift_hash<uint32_t>, arbitrary_resize> map(24);
+   test_map_batch(map);
+}
+TEST(batch, class32) {
+   separate_chaining_map<class_bucket<uint32_t>, class_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize> map;
+   test_map_batch(map);
+}
+TEST(batch, var_Xor_OverArray) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, array_overflow> map(20);
+   test_map_batch(map);
+}
+TEST(batch, var_Xor_OverHashed) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, hashed_overflow> map(20);
+   test_map_batch(map);
+}
+TEST(batch, var_set) {
+   separate_chaining_set<varwidth_bucket<>, hash_mapping_adapter<uint64_t, SplitMix>> set(40);
+   test_map_batch(set);
+}
+#ifdef __AVX2__
+TEST(batch, avx2_Xor) {
+   separate_chaining_map<avx2_bucket<uint32_t>, plain_bucket<uint32_t>, xorshift_hash<uint32_t>, incremental_resize> map(32);
+   test_map_batch(map);
+}
+#endif//__AVX2__
+
+
+template<class T>
+void test_map_incremental_rehash(T& map) {
+   using key_type = typename T::key_type;
+   std::map<key_type, typename T::value_type> rev;
+   map.incremental_rehash(1);
+   size_t rehashes = 0;
+   for(size_t i = 0; i < 100000; ++i) {
+      const key_type key = random_int<key_type>(map.max_key());
+      map[key] = rev[key] = i % map.max_value();
+      ASSERT_EQ(map.size(), rev.size());
+      if(map.rehash_pending()) {
+	 ++rehashes;
+	 if(i % 7 == 0) { // all keys remain accessible while the old buckets are migrated
+	    for(auto el : rev) {
+	       ASSERT_EQ(map.find(el.first)->second, el.second);
+	    }
+	 }
+	 if(i % 5 == 0) {
+	    const key_type erase_key = random_int<key_type>(map.max_key());
+	    ASSERT_EQ(map.erase(erase_key), rev.erase(erase_key));
+	 }
+      }
+   }
+   ASSERT_GT(rehashes, 0ULL);
+   size_t iterated = 0;
+   for(auto it = map.begin(); it != map.end(); ++it) {
+      ASSERT_EQ(rev[it->first], it->second);
+      ++iterated;
+   }
+   ASSERT_EQ(iterated, rev.size());
+   map.finish_rehash();
+   ASSERT_FALSE(map.rehash_pending());
+   for(auto el : rev) {
+      ASSERT_EQ(map.find(el.first)->second, el.second);
+   }
+}
+
+TEST(incremental_rehash, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize> map;
+   test_map_incremental_rehash(map);
+}
+TEST(incremental_rehash, var_Xor) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<uint64_t>, arbitrary_resize> map(24);
+   test_map_incremental_rehash(map);
+}
+
+template<class T>
+void test_map_build(T& map, const size_t num_elements, const size_t num_distinct_keys) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   std::set<key_type> distinct_key_set;
+   while(distinct_key_set.size() < num_distinct_keys) { distinct_key_set.insert(random_int<key_type>(map.max_key())); }
+   const std::vector<key_type> distinct_keys(distinct_key_set.begin(), distinct_key_set.end());
+   std::vector<key_type> keys(num_elements);
+   std::vector<value_type> values(num_elements);
+   std::map<key_type, value_type> rev;
+   for(size_t i = 0; i < num_elements; ++i) {
+      keys[i] = num_elements == num_distinct_keys ? distinct_keys[i] : distinct_keys[random_int<size_t>(num_distinct_keys)];
+      values[i] = random_int<value_type>(map.max_value());
+      rev.emplace(keys[i], values[i]); // the first occurrence wins
+   }
+   map.build(keys.begin(), keys.end(), values.begin());
+   ASSERT_EQ(map.size(), rev.size());
+   if(rev.size() == num_elements) { // each bucket is allocated exactly
+      ASSERT_EQ(map.capacity(), map.size());
+   }
+   for(auto el : rev) {
+      ASSERT_EQ(map.find(el.first)->second, el.second);
+   }
+   for(size_t i = 0; i < 1000; ++i) { // the table stays usable
+      const key_type key = random_int<key_type>(map.max_key());
+      const value_type value = random_int<value_type>(map.max_value());
+      map[key] = rev[key] = value;
+   }
+   ASSERT_EQ(map.size(), rev.size());
+   for(auto el : rev) {
+      ASSERT_EQ(map.find(el.first)->second, el.second);
+   }
+}
+
+TEST(build, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize> map;
+   test_map_build(map, 1000000, 1000000);
+}
+TEST(build, var_Xor_duplicates) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<uint64_t>, arbitrary_resize> map(32);
+   test_map_build(map, 100000, 10000);
+}
+TEST(build, heavy_duplicates) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, xorshift_hash<uint32_t>, incremental_resize, array_overflow> map(32);
+   test_map_build(map, 100000, 20);
+}
+TEST(build, set) {
+   separate_chaining_set<varwidth_bucket<>, hash_mapping_adapter<uint64_t, SplitMix>> set(40);
+   std::vector<uint64_t> keys(100000);
+   for(size_t i = 0; i < keys.size(); ++i) { keys[i] = random_int<uint64_t>(set.max_key()); }
+   set.build(keys.begin(), keys.end());
+   ASSERT_EQ(set.size(), std::set<uint64_t>(keys.begin(), keys.end()).size());
+   for(const uint64_t key : keys) { ASSERT_NE(set.find(key), set.cend()); }
+}
+
+TEST(slab_allocator, size_classes) {
+   slab_allocator allocator;
+   std::vector<std::pair<uint8_t*, size_t>> chunks;
+   for(size_t bytes = 1; bytes <= 3000; bytes += 7) {
+      const size_t alignment = bytes % 3 == 0 ? 32 : 8;
+      uint8_t* chunk = reinterpret_cast<uint8_t*>(allocator.allocate(bytes, alignment));
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(chunk) % alignment, 0ULL);
+      std::fill(chunk, chunk+bytes, static_cast<uint8_t>(bytes));
+      chunks.emplace_back(chunk, bytes);
+   }
+   for(auto& [chunk, bytes] : chunks) { // grow every chunk and check that its content is preserved
+      chunk = reinterpret_cast<uint8_t*>(allocator.reallocate(chunk, bytes, bytes+100));
+      for(size_t i = 0; i < bytes; ++i) { ASSERT_EQ(chunk[i], static_cast<uint8_t>(bytes)); }
+   }
+   const allocator_stats stats = allocator.stats();
+   ASSERT_GT(stats.slabs, 0ULL);
+   ASSERT_LE(stats.used_bytes, stats.reserved_bytes);
+   for(auto& el : chunks) { slab_allocator::deallocate(el.first); }
+   ASSERT_EQ(allocator.stats().used_bytes, 0ULL);
+   allocator.clear();
+   ASSERT_EQ(allocator.stats().slabs, 0ULL);
+}
+
+TEST(slab_allocator, table) {
+   separate_chaining_map<plain_bucket<uint32_t, slab_allocator>, plain_bucket<uint32_t, slab_allocator>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize, dummy_overflow, slab_allocator> map;
+   for(size_t i = 0; i < 100000; ++i) { map[i] = i; }
+   const allocator_stats stats = map.allocation_stats();
+   ASSERT_GT(stats.slabs, 0ULL);
+   ASSERT_GE(stats.used_bytes, map.size()*2*sizeof(uint32_t));
+   ASSERT_GE(stats.fragmentation(), 0.0);
+   ASSERT_LT(stats.fragmentation(), 1.0);
+   for(size_t i = 0; i < 100000; ++i) { ASSERT_EQ(map.erase(i), 1ULL); }
+   ASSERT_EQ(map.allocation_stats().used_bytes, 0ULL);
+   map.clear();
+   ASSERT_EQ(map.allocation_stats().slabs, 0ULL);
+}
+
+template<class T>
+void test_map_update(T& map) {
+   using key_type = typename T::key_type;
+   using value_type = typename T::value_type;
+   std::map<key_type, value_type> rev;
+   for(size_t i = 0; i < 100000; ++i) {
+      const key_type key = random_int<key_type>(1000);
+      const value_type value = random_int<value_type>(100);
+      switch(i % 3) {
+	 case 0: {
+	    const auto [it, inserted] = map.try_emplace(key, value);
+	    ASSERT_EQ(inserted, rev.find(key) == rev.end());
+	    rev.try_emplace(key, value);
+	    ASSERT_EQ(it.value(), rev[key]);
+	    break;
+	 }
+	 case 1: {
+	    const auto [it, inserted] = map.insert_or_assign(key, value);
+	    ASSERT_EQ(inserted, rev.find(key) == rev.end());
+	    rev[key] = value;
+	    ASSERT_EQ(it.value(), value);
+	    break;
+	 }
+	 default: {
+	    const auto [it, inserted] = map.upsert(key, value, std::plus<value_type>());
+	    ASSERT_EQ(inserted, rev.find(key) == rev.end());
+	    rev[key] += value;
+	    ASSERT_EQ(it.value(), rev[key]);
+	 }
+      }
+      ASSERT_EQ(map.size(), rev.size());
+   }
+   for(const auto& el : rev) {
+      ASSERT_EQ(map.find(el.first)->second, el.second);
+   }
+}
+
+TEST(update, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_map_update(map);
+}
+TEST(update, var_Xor_incremental) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint64_t>, xorshift_hash<uint64_t>, arbitrary_resize> map(32);
+   map.incremental_rehash(1);
+   test_map_update(map);
+}
+TEST(update, class32) {
+   separate_chaining_map<class_bucket<uint32_t>, class_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_map_update(map);
+}
+
+//! converts to a value and counts how often it got converted
+struct counting_value {
+   size_t& m_conversions;
+   operator uint32_t() const { ++m_conversions; return 7; }
+};
+
+TEST(update, try_emplace_constructs_on_insert) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   size_t conversions = 0;
+   for(size_t i = 0; i < 1000; ++i) {
+      map.try_emplace(i % 100, counting_value { conversions });
+   }
+   ASSERT_EQ(conversions, 100ULL);
+   ASSERT_EQ(map[42].value(), 7ULL);
+}
+
+//! the value is constructed once even if inserting into the overflow table fails and the table grows and retries the insertion
+TEST(update, try_emplace_constructs_once_on_overflow_failure) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize, map_overflow> map;
+   growth_policy policy;
+   policy.bucket_cap = 1; // almost every insertion goes to the overflow table, whose insertions fail on collisions
+   map.growth(policy);
+   size_t conversions = 0;
+   std::set<uint32_t> keys;
+   for(size_t i = 0; i < 2000; ++i) {
+      const uint32_t key = random_int<uint32_t>(std::numeric_limits<uint32_t>::max());
+      map.try_emplace(key, counting_value { conversions });
+      keys.insert(key);
+      ASSERT_EQ(conversions, keys.size());
+   }
+   for(const uint32_t key : keys) { ASSERT_EQ(map.find(key)->second, 7U); }
+}
+
+//! erases all odd keys by walking over the buckets, using `moved_from` to stay on the element moved into the gap
+template<class T>
+void test_erase_moved_from(T& map, const bool unordered) {
+   for(size_t i = 0; i < 10000; ++i) { map[i] = i; }
+   size_t erased = 0;
+   for(size_t bucket = 0; bucket < map.bucket_count(); ++bucket) {
+      for(size_t position = 0; position < map.bucket_size(bucket);) {
+         if(map.key_at(bucket, position) % 2 == 0) { ++position; continue; }
+         const size_t size = map.bucket_size(bucket);
+         size_t moved_from;
+         ASSERT_EQ(map.erase(bucket, position, moved_from), 1ULL);
+         ++erased;
+         if(position+1 == size) { ASSERT_EQ(moved_from, -1ULL); }
+         else { ASSERT_EQ(moved_from, unordered ? size-1 : position+1); }
+      }
+   }
+   ASSERT_EQ(erased, 5000ULL);
+   ASSERT_EQ(map.size(), 5000ULL);
+   for(size_t i = 0; i < 10000; ++i) {
+      ASSERT_EQ(map.count(i), 1-(i%2));
+      if(i % 2 == 0) { ASSERT_EQ(map.find(i)->second, i); }
+   }
+}
+
+TEST(erase_policy, ordered_moved_from) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_erase_moved_from(map, false);
+}
+TEST(erase_policy, unordered_moved_from) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, dummy_overflow, malloc_allocator, unordered_erase> map(32);
+   test_erase_moved_from(map, true);
+}
+TEST(erase_policy, compact_unordered_moved_from) {
+   compact_chaining_map<xorshift_hash<>, uint8_t, unordered_erase> map(32, 16);
+   test_erase_moved_from(map, true);
+}
+
+//! erases most keys of a large table, and checks that shrinking keeps the remaining keys
+template<class T>
+void test_map_shrink(T& map, const bool automatic) {
+   using key_type = typename T::key_type;
+   std::map<key_type, typename T::value_type> rev;
+   for(size_t i = 0; i < 100000; ++i) {
+      const key_type key = random_int<key_type>(map.max_key());
+      map[key] = i;
+      rev[key] = i;
+   }
+   const size_t initial_buckets = map.bucket_count();
+   if(automatic) { map.min_load_factor(4); }
+   for(auto it = rev.begin(); it != rev.end();) {
+      if(random_int<size_t>(100) < 99) {
+         ASSERT_EQ(map.erase(it->first), 1ULL);
+         it = rev.erase(it);
+      } else { ++it; }
+   }
+   if(!automatic) { map.rehash(1); }
+   ASSERT_LT(map.bucket_count(), initial_buckets);
+   ASSERT_LE(map.size(), map.max_size());
+   ASSERT_EQ(map.size(), rev.size());
+   for(const auto& el : rev) { ASSERT_EQ(map.find(el.first)->second, el.second); }
+   for(size_t i = 0; i < 10000; ++i) {
+      const key_type key = random_int<key_type>(map.max_key());
+      map[key] = i;
+      rev[key] = i;
+   }
+   ASSERT_EQ(map.size(), rev.size());
+   for(const auto& el : rev) { ASSERT_EQ(map.find(el.first)->second, el.second); }
+}
+
+TEST(stats, plain) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_map_stats(map);
+   ASSERT_EQ(map.stats().bucket_count, map.bucket_count());
+}
+TEST(stats, var_Xor_arbitrary) {
+   separate_chaining_map<varwidth_bucket<>, varwidth_bucket<>, xorshift_hash<>, arbitrary_resize> map(32, 7);
+   test_map_stats(map);
+   ASSERT_GT(map.stats().capacity_slack(), 0ULL);
+}
+TEST(stats, set_overflow) {
+   separate_chaining_set<varwidth_bucket<>, xorshift_hash<>, incremental_resize, array_overflow> set(32);
+   for(size_t i = 0; i < 10000; ++i) { set.find_or_insert(random_int<uint64_t>(set.max_key()), true); }
+   const table_stats stats = set.stats();
+   ASSERT_EQ(stats.elements, set.size());
+   ASSERT_EQ(stats.value_bytes, 0ULL);
+   ASSERT_EQ(stats.overflow_elements, set.m_overflow.size());
+   ASSERT_EQ(stats.capacity_slack(), 0ULL); // buckets grow one by one
+}
+TEST(stats, rehash_pending) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   map.incremental_rehash(1);
+   for(uint32_t i = 0; i < 100000 && !map.rehash_pending(); ++i) { map[i] = i; }
+   ASSERT_TRUE(map.rehash_pending());
+   const table_stats pending = map.stats();
+   ASSERT_EQ(pending.elements, map.size());
+   ASSERT_EQ(pending.bucket_count, map.bucket_count());
+   ASSERT_EQ(pending.bucket_elements(), map.size());
+   map.finish_rehash();
+   ASSERT_EQ(map.stats().bucket_elements(), map.size());
+}
+TEST(stats, compact) {
+   compact_chaining_map<xorshift_hash<>> map(32, 9);
+   test_map_stats(map);
+   ASSERT_EQ(map.stats().bucket_count, map.bucket_count());
+}
+TEST(stats, empty) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   const table_stats stats = map.stats();
+   ASSERT_EQ(stats.bucket_count, 0ULL);
+   ASSERT_EQ(stats.average_chain_length(), 0.0);
+   ASSERT_EQ(stats.load_factor(), 0.0);
+}
+
+TEST(shrink, plain_rehash) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   test_map_shrink(map, false);
+}
+TEST(shrink, var_Xor_rehash) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, arbitrary_resize> map(32);
+   map.incremental_rehash(2);
+   test_map_shrink(map, false);
+}
+TEST(shrink, var_Xor_OverArray_automatic) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize, array_overflow> map(32);
+   test_map_shrink(map, true);
+}
+TEST(shrink, avx2_automatic) {
+   separate_chaining_map<avx2_bucket<uint32_t>, plain_bucket<uint32_t>, xorshift_hash<uint32_t>, incremental_resize, dummy_overflow, malloc_allocator, unordered_erase> map(32);
+   test_map_shrink(map, true);
+}
+
+//! maps every multiple of 64 to the bucket 0, such that this bucket becomes hot
+struct skewed_hash {
+   uint64_t operator()(const uint64_t& x) const { return x % 64 == 0 ? 0 : SplitMix()(x); }
+};
+
+template<class T>
+void test_growth_contents(const T& map, const std::map<typename T::key_type, typename T::value_type>& rev) {
+   ASSERT_EQ(map.size(), rev.size());
+   for(const auto& el : rev) { ASSERT_EQ(map.find(el.first)->second, el.second); }
+}
+
+//! maps every multiple of 2^12 to itself, such that these keys share the bucket 0 of a table with 2^12 buckets, but not of a larger one
+struct sparse_hash {
+   uint64_t operator()(const uint64_t& x) const { return x % (1ULL<<12) == 0 ? x : SplitMix()(x); }
+};
+
+//! starts an incremental rehash on a table with 2^12 buckets, of which only the bucket 0 is non-empty
+TEST(incremental_rehash, sparse) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, sparse_hash>, incremental_resize, dummy_overflow> map;
+   growth_policy policy;
+   policy.bucket_cap = 16;
+   map.growth(policy);
+   map.reserve(1ULL<<12);
+   map.incremental_rehash(1);
+   std::map<uint32_t, uint32_t> rev;
+   for(uint32_t i = 0; !map.rehash_pending(); ++i) {
+      ASSERT_LE(i, 16);
+      map[i<<12] = rev[i<<12] = i;
+   }
+   // each operation visits at most REHASH_VISITS_PER_STEP old buckets instead of scanning the empty buckets to the end
+   const size_t operations = (1ULL<<12) / REHASH_VISITS_PER_STEP;
+   size_t i = 0;
+   for(; i < 2*operations && map.rehash_pending(); ++i) {
+      const uint32_t key = random_int<uint32_t>(std::numeric_limits<uint32_t>::max()) | 1;
+      map[key] = rev[key] = i;
+   }
+   ASSERT_FALSE(map.rehash_pending());
+   ASSERT_GE(i+1, operations);
+   test_growth_contents(map, rev);
+}
+
+TEST(growth, max_load_factor) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   growth_policy policy;
+   policy.max_load_factor = 2;
+   map.growth(policy);
+   std::map<uint32_t, uint32_t> rev;
+   for(uint32_t i = 0; i < 100000; ++i) {
+      const uint32_t key = random_int<uint32_t>(std::numeric_limits<uint32_t>::max());
+      map[key] = i;
+      rev[key] = i;
+      ASSERT_LE(map.load_factor(), 2.0f);
+   }
+   test_growth_contents(map, rev);
+   ASSERT_GE(map.bucket_count(), rev.size()/2);
+}
+
+TEST(growth, bucket_cap) {
+   separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>, incremental_resize> map(32);
+   map.incremental_rehash(4);
+   growth_policy policy;
+   policy.bucket_cap = 8;
+   map.growth(policy);
+   ASSERT_EQ(map.bucket_cap(), 8ULL);
+   std::map<uint64_t, uint32_t> rev;
+   for(uint32_t i = 0; i < 100000; ++i) {
+      const uint64_t key = random_int<uint64_t>(map.max_key());
+      map[key] = i;
+      rev[key] = i;
+   }
+   map.finish_rehash();
+   test_growth_contents(map, rev);
+   for(size_t bucket = 0; bucket < map.bucket_count(); ++bucket) { ASSERT_LE(map.bucket_size(bucket), 8); }
+   ASSERT_LE(map.size(), map.max_size());
+}
+
+TEST(growth, hot_buckets) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, skewed_hash>, incremental_resize, array_overflow> map;
+   growth_policy policy;
+   policy.bucket_cap = 16;
+   policy.hot_load_factor = 4;
+   map.growth(policy);
+   std::map<uint32_t, uint32_t> rev;
+   for(uint32_t i = 0; i < 400; ++i) { // keys of the hot bucket 0, more than the overflow table can take
+      map[i*64] = i;
+      rev[i*64] = i;
+   }
+   for(uint32_t i = 0; i < 20000; ++i) {
+      const uint32_t key = random_int<uint32_t>(std::numeric_limits<uint32_t>::max()) | 1;
+      map[key] = i;
+      rev[key] = i;
+   }
+   test_growth_contents(map, rev);
+   ASSERT_GT(map.m_overflow.size(), 0ULL);
+   ASSERT_GT(map.bucket_size(0), 16);
+   ASSERT_LE(map.bucket_count(), 1ULL<<14); // without hot buckets, the table could not stop doubling for the bucket 0
+}
+
+//! compares `overflow` with the content of `rev`, and checks that the positions are dense
+template<class overflow_type>
+void test_overflow_contents(const overflow_type& overflow, const std::map<uint64_t, uint32_t>& rev) {
+   ASSERT_EQ(overflow.size(), rev.size());
+   for(const auto& el : rev) {
+      const size_t position = overflow.find(el.first);
+      ASSERT_LT(position, overflow.size());
+      ASSERT_EQ(overflow.key(position), el.first);
+      ASSERT_EQ(overflow[position], el.second);
+   }
+   for(size_t position = overflow.first_position(); overflow.valid_position(position); position = overflow.next_position(position)) {
+      ASSERT_NE(rev.find(overflow.key(position)), rev.end());
+   }
+}
+
+//! fills a `hashed_overflow`, erases a random half of its keys and refills it, checking the lookups and a serialized copy
+void test_hashed_overflow(const uint_fast8_t key_width, const uint_fast8_t value_width) {
+   using overflow_type = hashed_overflow<uint64_t, uint32_t>;
+   overflow_type overflow(key_width, value_width);
+   overflow.resize_buckets(1, key_width, value_width);
+   std::map<uint64_t, uint32_t> rev;
+   const uint64_t max_key = -1ULL >> (64-key_width);
+   const uint32_t max_value = -1U >> (32-value_width);
+   const size_t elements = std::min<size_t>(overflow.capacity(), max_key/2);
+   for(size_t round = 0; round < 3; ++round) {
+      while(rev.size() < elements) {
+         const uint64_t key = random_int<uint64_t>(max_key);
+         if(rev.find(key) != rev.end()) { ASSERT_NE(overflow.find(key), -1ULL); continue; }
+         ASSERT_EQ(overflow.find(key), -1ULL);
+         const uint32_t value = random_int<uint32_t>(max_value);
+         const size_t position = overflow.insert(0, key, value);
+         ASSERT_LT(position, overflow.capacity());
+         rev[key] = value;
+         ASSERT_EQ(overflow.key(position), key);
+      }
+      if(elements == overflow.capacity()) { ASSERT_EQ(overflow.insert(0, max_key, 0), -1ULL); }
+      test_overflow_contents(overflow, rev);
+      for(auto it = rev.begin(); it != rev.end();) {
+         if(std::rand() % 2) { ++it; continue; }
+         overflow.erase(overflow.find(it->first));
+         ASSERT_EQ(overflow.find(it->first), -1ULL);
+         it = rev.erase(it);
+      }
+      test_overflow_contents(overflow, rev);
+      if(!rev.empty()) {
+         const uint32_t value = random_int<uint32_t>(max_value);
+         overflow[overflow.find(rev.begin()->first)] = value;
+         rev.begin()->second = value;
+      }
+   }
+   std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios::binary);
+   overflow.serialize(ss);
+   overflow_type copy(64, 32);
+   copy.deserialize(ss);
+   copy.resize_buckets(1, key_width, value_width);
+   ASSERT_TRUE(copy.need_consult(0));
+   test_overflow_contents(copy, rev);
+   overflow.clear();
+   ASSERT_EQ(overflow.size(), 0ULL);
+   ASSERT_EQ(overflow.find(rev.begin()->first), -1ULL);
+}
+
+TEST(overflow, hashed) {
+   test_hashed_overflow(64, 32);
+   test_hashed_overflow(33, 7);
+   test_hashed_overflow(6, 1); // fewer key bits than slots: the quotients are empty
+}
+
+//! fills a `hashed_overflow` with keys overflowing from a single bucket of a table with 2^12 buckets using the same hash function, whose keys share the lowest bits of their hash values
+TEST(overflow, hashed_single_bucket) {
+   constexpr uint_fast8_t key_width = 32;
+   constexpr uint_fast8_t table_buckets = 12;
+   const xorshift_hash<> hash(key_width);
+   hashed_overflow<uint64_t, uint32_t> overflow(key_width, 32);
+   overflow.resize_buckets(1ULL<<table_buckets, key_width, 32);
+   std::set<uint64_t> keys;
+   while(keys.size() < overflow.capacity()) {
+      const uint64_t key = hash.inv_map(random_int<uint64_t>(1ULL<<(key_width-table_buckets)), 42, table_buckets);
+      ASSERT_EQ(hash.map(key, table_buckets).second, 42ULL);
+      if(!keys.insert(key).second) { continue; }
+      ASSERT_LT(overflow.insert(42, key, keys.size()), overflow.capacity());
+   }
+   size_t total_probes = 0;
+   for(const uint64_t key : keys) {
+      const size_t position = overflow.find(key);
+      ASSERT_LT(position, overflow.capacity());
+      ASSERT_EQ(overflow.key(position), key);
+      ASSERT_LT(overflow.probe_length(position), 64ULL);
+      total_probes += overflow.probe_length(position);
+   }
+   ASSERT_LT(total_probes, 4*keys.size()); // linear probing on a table filled to one half expects 0.5 probes per element
+}
+
+TEST(growth, hot_buckets_hashed_overflow) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, skewed_hash>, incremental_resize, hashed_overflow> map;
+   growth_policy policy;
+   policy.bucket_cap = 16;
+   policy.hot_load_factor = 4;
+   map.growth(policy);
+   std::map<uint32_t, uint32_t> rev;
+   for(uint32_t i = 0; i < 200; ++i) {
+      map[i*64] = i;
+      rev[i*64] = i;
+   }
+   ASSERT_GT(map.m_overflow.size(), 0ULL);
+   for(uint32_t i = 0; i < 200; i += 3) {
+      map.erase(i*64);
+      rev.erase(i*64);
+   }
+   test_growth_contents(map, rev);
+}
+
+TEST(growth, invalid) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   growth_policy policy;
+   policy.bucket_cap = 0;
+   ASSERT_THROW(map.growth(policy), std::runtime_error);
+   policy.bucket_cap = 4;
+   policy.max_load_factor = -1;
+   ASSERT_THROW(map.growth(policy), std::runtime_error);
+}
+
+TEST(instrumentation, counting) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, arbitrary_resize, dummy_overflow, malloc_allocator, ordered_erase, counting_instrumentation> map;
+   std::vector<uint32_t> keys;
+   for(uint32_t i = 0; i < 10000; ++i) { 
+      keys.push_back(random_int<uint32_t>(std::numeric_limits<uint32_t>::max()));
+      map[keys.back()] = i;
+   }
+   probe_counters counters = map.counters();
+   ASSERT_GT(counters.rehashes, 0ULL);
+   ASSERT_GE(counters.rehash_seconds, 0.0);
+   ASSERT_GT(counters.bucket_resizes, 0ULL);
+   ASSERT_GT(counters.bytes_moved, 0ULL);
+   ASSERT_EQ(counters.locates, counters.hits + counters.misses);
+
+   map.reset_counters();
+   ASSERT_EQ(map.counters().locates, 0ULL);
+   for(const uint32_t key : keys) { ASSERT_NE(map.find(key), map.cend()); }
+   counters = map.counters();
+   ASSERT_EQ(counters.locates, keys.size());
+   ASSERT_EQ(counters.hits, keys.size());
+   ASSERT_EQ(counters.misses, 0ULL);
+   ASSERT_GE(counters.comparisons, keys.size());
+   ASSERT_EQ(counters.overflow_consults, 0ULL);
+   ASSERT_EQ(counters.rehashes, 0ULL);
+
+   map.reset_counters();
+   size_t missing = 0;
+   for(uint32_t i = 0; i < 1000; ++i) { missing += map.count(random_int<uint32_t>(std::numeric_limits<uint32_t>::max())) == 0; }
+   ASSERT_EQ(map.counters().misses, missing);
+}
+
+TEST(instrumentation, overflow) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, skewed_hash>, incremental_resize, array_overflow, malloc_allocator, ordered_erase, counting_instrumentation> map;
+   for(uint32_t i = 0; i < 400; ++i) { map[i*64] = i; } // keys of the bucket 0
+   ASSERT_GT(map.m_overflow.size(), 0ULL);
+   map.reset_counters();
+   for(uint32_t i = 0; i < 400; ++i) { ASSERT_EQ(map.find(i*64)->second, i); }
+   const probe_counters counters = map.counters();
+   ASSERT_GT(counters.overflow_consults, 0ULL);
+   ASSERT_EQ(counters.overflow_hits + counters.hits, 400ULL);
+}
+
+TEST(instrumentation, disabled) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>> map;
+   for(uint32_t i = 0; i < 1000; ++i) { map[i] = i; }
+   ASSERT_EQ(map.counters().locates, 0ULL);
+   ASSERT_EQ(map.counters().rehashes, 0ULL);
+}
+
+//! hashes each key once and uses the handle for lookups in two tables of the same size
+TEST(hashed, shared_between_tables) {
+   using map_type = separate_chaining_map<varwidth_bucket<>, plain_bucket<uint32_t>, xorshift_hash<>>;
+   map_type first(32);
+   map_type second(32);
+   std::map<uint64_t, uint32_t> rev;
+   for(uint32_t i = 0; i < 10000; ++i) {
+      const uint64_t key = random_int<uint64_t>(first.max_key());
+      rev[key] = i;
+      first[key] = i;
+   }
+   second.reserve(first.bucket_count());
+   for(const auto& el : rev) {
+      const auto hashed = first.hash(el.first);
+      ASSERT_EQ(hashed.generation, second.bucket_count_log2());
+      second.find_or_insert(hashed, el.second+1);
+   }
+   ASSERT_EQ(second.bucket_count_log2(), first.bucket_count_log2());
+   for(size_t i = 0; i < 20000; ++i) {
+      const uint64_t key = i % 2 == 0 ? std::next(rev.begin(), i % rev.size())->first : random_int<uint64_t>(first.max_key());
+      const auto hashed = first.hash(key);
+      const auto it = first.find(hashed);
+      ASSERT_EQ(it, first.find(key));
+      ASSERT_EQ(second.find(hashed) == second.cend(), it == first.cend());
+      if(it != first.cend()) { ASSERT_EQ(second.find(hashed)->second, it->second+1); }
+   }
+}
+
+TEST(hashed, empty_and_rehash_pending) {
+   separate_chaining_map<plain_bucket<uint32_t>, plain_bucket<uint32_t>, hash_mapping_adapter<uint32_t, SplitMix>, incremental_resize> map;
+   ASSERT_EQ(map.find(map.hash(3)), map.cend());
+   map.incremental_rehash(1);
+   size_t i = 0;
+   for(; i < 100000 && !map.rehash_pending(); ++i) { map.find_or_insert(map.hash(i), i); }
+   ASSERT_TRUE(map.rehash_pending());
+   for(size_t j = 0; j < i; ++j) { ASSERT_EQ(map.find(map.hash(j))->second, j); }
+   ASSERT_EQ(map.find(map.hash(i)), map.cend());
+}
+
 template<class T>
 void test_set_random(T& set) {
    using key_type = typename T::key_type;